@@ -6,6 +6,7 @@ add_library(${DRIVER_NAME} INTERFACE)
 target_sources(${DRIVER_NAME} INTERFACE
   ${CMAKE_CURRENT_LIST_DIR}/dvi.cpp
   ${CMAKE_CURRENT_LIST_DIR}/${DRIVER_NAME}.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/${DRIVER_NAME}_terminal.cpp
   
   ${CMAKE_CURRENT_LIST_DIR}/intel_one_mono_2bpp.c
   )
@@ -33,17 +33,31 @@ __attribute__((section(".uninitialized_data"))) static uint8_t frame_buffer_b[FR
 
 #include "font.h"
 
-// If changing the font, note this code will not handle glyphs wider than 13 pixels
+// The built in font, used when no bitmap font is set.  Its glyphs are up to
+// 13 pixels wide and are displayed in 14 x 24 cells unless scaled.
 #define FONT (&intel_one_mono)
 
-// The first displayable character in text mode is FIRST_GLYPH, and the total
-// number of glyphs is GLYPH_COUNT. This makes the last displayable character
-// (FIRST_GLYPH + GLYPH_COUNT - 1) or 126, ASCII tilde.
+// With the ASCII character set, the first displayable character in text mode
+// is FIRST_GLYPH, and the total number of glyphs is GLYPH_COUNT. This makes the
+// last displayable character (FIRST_GLYPH + GLYPH_COUNT - 1) or 126, ASCII tilde.
 //
 // Because all glyphs not present in the cache are displayed as blank, there's
 // no need to include space among the cached glyphs.
 constexpr int FIRST_GLYPH=33, GLYPH_COUNT=95;
 
+// The 8-bit character sets cache every character except 0.
+constexpr int FIRST_GLYPH_8BIT=1, GLYPH_COUNT_8BIT=255;
+
+// The font cache holds one row of every glyph for each line of the font, followed
+// by a blank entry so characters outside the cache can be looked up without a branch.
+// Each row is glyph count + 1 entries.
+
+// On Hazard3 the RGB111 text kernel spreads glyph pixels to bytes with the
+// Zbkb zip instruction, which needs the font cache in a different layout.
+#if defined(__riscv) && defined(__riscv_zbkb)
+#define TEXT_RGB111_ZIP 1
+#endif
+
 #ifdef MICROPY_BUILD_TYPE
 extern "C" {
 void dvhstx_debug(const char *fmt, ...);
@@ -72,6 +86,314 @@ static inline __attribute__((always_inline)) uint32_t render_char_line(int c, in
     }
 }
 
+// Font cache lines hold 2 bits per pixel.  Pixel 0 is in bits 25:24 and
+// later pixels follow in the lower bits, with pixels 13 to 15 wrapping
+// round to the top of the word.  This matches the order the HSTX shifts
+// out mono text pixels.
+static inline uint32_t pack_char_pixel(int x, uint32_t level) {
+    return level << ((24 - 2 * x) & 31);
+}
+
+static uint32_t font_char_line(const DVHSTX::TextFont& font, int c, int y) {
+    uint32_t bits = 0;
+
+    if (font.bitmap) {
+        if (c < font.first_char || c >= font.first_char + font.glyph_count) return 0;
+
+        const int row_bytes = (font.cell_width + 7) >> 3;
+        const uint8_t* row = font.bitmap + ((c - font.first_char) * font.cell_height + y) * row_bytes;
+        for (int x = 0; x < font.cell_width; ++x) {
+            if (row[x >> 3] & (0x80 >> (x & 7))) bits |= pack_char_pixel(x, 3);
+        }
+        return bits;
+    }
+
+    if (font.cell_width == 14 && font.cell_height == FONT->line_height) {
+        return render_char_line(c, y);
+    }
+
+    if (font.cell_width >= 14 && font.cell_height >= FONT->line_height) {
+        // Centre the built in font in the larger cell
+        const int sy = y - ((font.cell_height - FONT->line_height) >> 1);
+        if (sy < 0 || sy >= FONT->line_height) return 0;
+
+        const uint32_t src_bits = render_char_line(c, sy);
+        const int ox = (font.cell_width - 14) >> 1;
+        for (int x = 0; x < 13; ++x) {
+            bits |= pack_char_pixel(x + ox, (src_bits >> (24 - 2 * x)) & 3);
+        }
+        return bits;
+    }
+
+    // Scale the built in font to the cell, averaging 4x4 samples per pixel
+    uint32_t src_bits[4];
+    for (int j = 0; j < 4; ++j) {
+        src_bits[j] = render_char_line(c, ((y * 4 + j) * 2 + 1) * FONT->line_height / (font.cell_height * 8));
+    }
+    for (int x = 0; x < font.cell_width; ++x) {
+        int total = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int sx = ((x * 4 + i) * 2 + 1) * 14 / (font.cell_width * 8);
+            if (sx >= 13) continue;
+            for (int j = 0; j < 4; ++j) {
+                total += (src_bits[j] >> (24 - 2 * sx)) & 3;
+            }
+        }
+        bits |= pack_char_pixel(x, (total + 8) >> 4);
+    }
+    return bits;
+}
+
+// Characters in the 8-bit character sets that are not in the font are built
+// from simple graphics, or from a font character with an accent or other mark.
+enum CharMark : uint8_t {
+    MARK_NONE,
+    MARK_GRAVE,
+    MARK_ACUTE,
+    MARK_CIRCUMFLEX,
+    MARK_TILDE,
+    MARK_DIAERESIS,
+    MARK_RING,
+    MARK_CEDILLA,
+    MARK_ROTATE,  // Base character rotated 180 degrees
+};
+
+struct CharComposition {
+    char base;
+    CharMark mark;
+};
+
+// Marks are 5 pixels wide and 3 rows high in the 14 x 24 built in font cell,
+// and are scaled with the cell for other fonts.
+static const uint8_t char_mark_rows[][3] = {
+    {0b00000, 0b00000, 0b00000},
+    {0b11000, 0b01100, 0b00110},
+    {0b00011, 0b00110, 0b01100},
+    {0b00100, 0b01110, 0b11011},
+    {0b00000, 0b01101, 0b10110},
+    {0b00000, 0b11011, 0b11011},
+    {0b01110, 0b10001, 0b01110},
+    {0b00110, 0b00011, 0b01110},
+};
+
+// CP437 0x80 to 0xAF
+static const CharComposition cp437_compositions[] = {
+    {'C', MARK_CEDILLA}, {'u', MARK_DIAERESIS}, {'e', MARK_ACUTE}, {'a', MARK_CIRCUMFLEX},
+    {'a', MARK_DIAERESIS}, {'a', MARK_GRAVE}, {'a', MARK_RING}, {'c', MARK_CEDILLA},
+    {'e', MARK_CIRCUMFLEX}, {'e', MARK_DIAERESIS}, {'e', MARK_GRAVE}, {'i', MARK_DIAERESIS},
+    {'i', MARK_CIRCUMFLEX}, {'i', MARK_GRAVE}, {'A', MARK_DIAERESIS}, {'A', MARK_RING},
+    {'E', MARK_ACUTE}, {0, MARK_NONE}, {0, MARK_NONE}, {'o', MARK_CIRCUMFLEX},
+    {'o', MARK_DIAERESIS}, {'o', MARK_GRAVE}, {'u', MARK_CIRCUMFLEX}, {'u', MARK_GRAVE},
+    {'y', MARK_DIAERESIS}, {'O', MARK_DIAERESIS}, {'U', MARK_DIAERESIS}, {0, MARK_NONE},
+    {0, MARK_NONE}, {0, MARK_NONE}, {0, MARK_NONE}, {0, MARK_NONE},
+    {'a', MARK_ACUTE}, {'i', MARK_ACUTE}, {'o', MARK_ACUTE}, {'u', MARK_ACUTE},
+    {'n', MARK_TILDE}, {'N', MARK_TILDE}, {0, MARK_NONE}, {0, MARK_NONE},
+    {'?', MARK_ROTATE}, {0, MARK_NONE}, {0, MARK_NONE}, {0, MARK_NONE},
+    {0, MARK_NONE}, {'!', MARK_ROTATE}, {0, MARK_NONE}, {0, MARK_NONE},
+};
+
+// Latin-1 0xC0 to 0xDF, 0xE0 to 0xFF are the same with lower case base characters
+static const CharComposition latin1_compositions[] = {
+    {'A', MARK_GRAVE}, {'A', MARK_ACUTE}, {'A', MARK_CIRCUMFLEX}, {'A', MARK_TILDE},
+    {'A', MARK_DIAERESIS}, {'A', MARK_RING}, {0, MARK_NONE}, {'C', MARK_CEDILLA},
+    {'E', MARK_GRAVE}, {'E', MARK_ACUTE}, {'E', MARK_CIRCUMFLEX}, {'E', MARK_DIAERESIS},
+    {'I', MARK_GRAVE}, {'I', MARK_ACUTE}, {'I', MARK_CIRCUMFLEX}, {'I', MARK_DIAERESIS},
+    {0, MARK_NONE}, {'N', MARK_TILDE}, {'O', MARK_GRAVE}, {'O', MARK_ACUTE},
+    {'O', MARK_CIRCUMFLEX}, {'O', MARK_TILDE}, {'O', MARK_DIAERESIS}, {0, MARK_NONE},
+    {0, MARK_NONE}, {'U', MARK_GRAVE}, {'U', MARK_ACUTE}, {'U', MARK_CIRCUMFLEX},
+    {'U', MARK_DIAERESIS}, {'Y', MARK_ACUTE}, {0, MARK_NONE}, {0, MARK_NONE},
+};
+
+// CP437 box drawing characters 0xB3 to 0xDA, as the weight of the line
+// leaving the cell (0 none, 1 single, 2 double) up, down, left and right.
+#define BOX(u, d, l, r) ((u) | ((d) << 2) | ((l) << 4) | ((r) << 6))
+static const uint8_t cp437_box_lines[] = {
+    BOX(1,1,0,0), BOX(1,1,1,0), BOX(1,1,2,0), BOX(2,2,1,0), BOX(0,2,1,0), BOX(0,1,2,0), BOX(2,2,2,0), BOX(2,2,0,0),
+    BOX(0,2,2,0), BOX(2,0,2,0), BOX(2,0,1,0), BOX(1,0,2,0), BOX(0,1,1,0), BOX(1,0,0,1), BOX(1,0,1,1), BOX(0,1,1,1),
+    BOX(1,1,0,1), BOX(0,0,1,1), BOX(1,1,1,1), BOX(1,1,0,2), BOX(2,2,0,1), BOX(2,0,0,2), BOX(0,2,0,2), BOX(2,0,2,2),
+    BOX(0,2,2,2), BOX(2,2,0,2), BOX(0,0,2,2), BOX(2,2,2,2), BOX(1,0,2,2), BOX(2,0,1,1), BOX(0,1,2,2), BOX(0,2,1,1),
+    BOX(2,0,0,1), BOX(1,0,0,2), BOX(0,1,0,2), BOX(0,2,0,1), BOX(2,2,1,1), BOX(1,1,2,2), BOX(1,0,1,0), BOX(0,1,0,1),
+};
+#undef BOX
+
+// Draw one arm of a box drawing character.  The arm runs from the cell edge
+// towards the centre, and stops where it meets the lines crossing it.  Lines
+// are t pixels thick, with double lines centred t pixels either side of the
+// centre line.  along is the position along the arm, across the position
+// across it, and centre is the start of the centre line in each direction.
+static bool box_arm_pixel(int weight, bool to_start, int along, int across, int centre_along, int centre_across,
+                          int side_before, int side_after, int t) {
+    auto offset = [t](int w) { return (w == 2) ? t : 0; };
+
+    for (int line = (weight == 2) ? -1 : 0; line <= ((weight == 2) ? 1 : 0); line += 2) {
+        const int line_start = centre_across + line * t;
+        if (across < line_start || across >= line_start + t) {
+            if (weight == 2 && line == -1) continue;
+            break;
+        }
+
+        // Find the crossing line this one stops at
+        int stop;
+        if (line == 0) {
+            stop = std::max(offset(side_before), offset(side_after));
+            if (to_start) stop = -stop;
+        }
+        else {
+            const int near_side = (line < 0) ? side_before : side_after;
+            const int far_side = (line < 0) ? side_after : side_before;
+            if (near_side) stop = to_start ? -offset(near_side) : offset(near_side);
+            else if (far_side) stop = to_start ? offset(far_side) : -offset(far_side);
+            else stop = 0;
+        }
+
+        if (to_start) return along < centre_along + stop + t;
+        return along >= centre_along + stop;
+    }
+    return false;
+}
+
+static uint32_t cp437_graphics_char_line(int c, int y, int w, int h) {
+    uint32_t bits = 0;
+
+    if (c >= 0xB0 && c <= 0xB2) {
+        // Shades
+        for (int x = 0; x < w; ++x) {
+            const bool odd = (x + y) & 1;
+            const uint32_t level = (c == 0xB0) ? 1 : (c == 0xB1) ? (odd ? 2 : 1) : (odd ? 3 : 2);
+            bits |= pack_char_pixel(x, level);
+        }
+    }
+    else if (c >= 0xB3 && c <= 0xDA) {
+        const uint8_t lines = cp437_box_lines[c - 0xB3];
+        const int up = lines & 3, down = (lines >> 2) & 3, left = (lines >> 4) & 3, right = (lines >> 6) & 3;
+        const int t = std::max(1, (w + 4) >> 3);
+        const int cx = (w - t) >> 1;
+        const int cy = (h - t) >> 1;
+        for (int x = 0; x < w; ++x) {
+            const bool set = (up && box_arm_pixel(up, true, y, x, cy, cx, left, right, t)) ||
+                             (down && box_arm_pixel(down, false, y, x, cy, cx, left, right, t)) ||
+                             (left && box_arm_pixel(left, true, x, y, cx, cy, up, down, t)) ||
+                             (right && box_arm_pixel(right, false, x, y, cx, cy, up, down, t));
+            if (set) bits |= pack_char_pixel(x, 3);
+        }
+    }
+    else if (c >= 0xDB && c <= 0xDF) {
+        // Blocks
+        for (int x = 0; x < w; ++x) {
+            const bool set = (c == 0xDB) ||
+                             (c == 0xDC && y >= (h >> 1)) ||
+                             (c == 0xDD && x < (w >> 1)) ||
+                             (c == 0xDE && x >= (w >> 1)) ||
+                             (c == 0xDF && y < (h >> 1));
+            if (set) bits |= pack_char_pixel(x, 3);
+        }
+    }
+    else if (c == 0xFE) {
+        // Small square
+        if (y >= (h >> 2) + (h >> 3) && y < h - (h >> 2)) {
+            for (int x = w >> 2; x < w - (w >> 2); ++x) bits |= pack_char_pixel(x, 3);
+        }
+    }
+    return bits;
+}
+
+// Middle dot, used by both 8-bit character sets
+static uint32_t middle_dot_char_line(int y, int w, int h) {
+    const int t = std::max(1, (w + 4) >> 3);
+    uint32_t bits = 0;
+    if (y >= ((h - t) >> 1) && y < ((h - t) >> 1) + t) {
+        for (int x = (w - t) >> 1; x < ((w - t) >> 1) + t; ++x) bits |= pack_char_pixel(x, 3);
+    }
+    return bits;
+}
+
+static uint32_t mark_char_line(CharMark mark, bool upper_case, int y, int w, int h) {
+    const int sy = ((2 * y + 1) * 24) / (2 * h);
+    const int row = sy - ((mark == MARK_CEDILLA) ? 18 : upper_case ? 0 : 3);
+    if (row < 0 || row > 2) return 0;
+
+    uint32_t bits = 0;
+    for (int x = 0; x < w; ++x) {
+        const int col = ((2 * x + 1) * 14) / (2 * w) - 4;
+        if (col >= 0 && col < 5 && ((char_mark_rows[mark][row] >> (4 - col)) & 1)) bits |= pack_char_pixel(x, 3);
+    }
+    return bits;
+}
+
+static uint32_t generate_char_line(const DVHSTX::TextFont& font, DVHSTX::TextCharset charset, int c, int y) {
+    const int w = font.cell_width;
+    const int h = font.cell_height;
+
+    if (charset == DVHSTX::CHARSET_ASCII || (c >= 0x20 && c < 0x7f) ||
+        (font.bitmap && c >= font.first_char && c < font.first_char + font.glyph_count)) {
+        return font_char_line(font, c, y);
+    }
+
+    CharComposition composition = {0, MARK_NONE};
+    if (charset == DVHSTX::CHARSET_CP437) {
+        if (c >= 0xB0 || c == 0xFE) {
+            if (c == 0xF8) composition = {' ', MARK_RING};
+            else if (c == 0xF9 || c == 0xFA) return middle_dot_char_line(y, w, h);
+            else return cp437_graphics_char_line(c, y, w, h);
+        }
+        else if (c >= 0x80) composition = cp437_compositions[c - 0x80];
+    }
+    else {
+        if (c >= 0xC0) {
+            composition = latin1_compositions[c & 0x1F];
+            if (c == 0xFF) composition = {'Y', MARK_DIAERESIS};
+            if (c >= 0xE0 && composition.base) composition.base += 0x20;
+        }
+        else if (c == 0xA1) composition = {'!', MARK_ROTATE};
+        else if (c == 0xBF) composition = {'?', MARK_ROTATE};
+        else if (c == 0xB0) composition = {' ', MARK_RING};
+        else if (c == 0xB7) return middle_dot_char_line(y, w, h);
+    }
+
+    if (!composition.base) return 0;
+
+    if (composition.mark == MARK_ROTATE) {
+        const uint32_t src_bits = font_char_line(font, composition.base, h - 1 - y);
+        uint32_t bits = 0;
+        for (int x = 0; x < w; ++x) {
+            bits |= pack_char_pixel(w - 1 - x, (src_bits >> ((24 - 2 * x) & 31)) & 3);
+        }
+        return bits;
+    }
+
+    const bool upper_case = composition.base < 'a';
+    uint32_t bits = font_char_line(font, composition.base, y);
+
+    // Remove the dot from i when it has an accent
+    if (composition.base == 'i' && composition.mark != MARK_CEDILLA && ((2 * y + 1) * 24) / (2 * h) < 7) bits = 0;
+
+    return bits | mark_char_line(composition.mark, upper_case, y, w, h);
+}
+
+#ifdef TEXT_RGB111_ZIP
+// Rearrange a rendered glyph line so that zip(bits >> g) & 0x03030303 gives
+// pixels 4g to 4g+3 in the low bits of each byte.  The glyph is offset by
+// offset pixels, so odd characters can be placed after an even character
+// within the same words.
+static uint32_t zip_char_line(uint32_t bits, int offset) {
+    uint32_t zbits = 0;
+    for (int i = 0; i < 14; ++i) {
+        const uint32_t level = (bits >> ((24 - 2 * i) & 31)) & 3;
+        const int p = i + offset;
+        const int pos = ((p & 3) << 2) + (p >> 2);
+        zbits |= (level & 1) << pos;
+        zbits |= (level >> 1) << (16 + pos);
+    }
+    return zbits;
+}
+
+static inline __attribute__((always_inline)) uint32_t zip(uint32_t x) {
+    uint32_t r;
+    asm ("zip %0, %1" : "=r" (r) : "r" (x));
+    return r;
+}
+#endif
+
 // ----------------------------------------------------------------------------
 // HSTX command lists
 
@@ -109,29 +431,39 @@ static const uint32_t vactive_line_header_src[] = {
 };
 static uint32_t vactive_line_header[count_of(vactive_line_header_src)];
 
-static const uint32_t vactive_text_line_header_src[] = {
-    HSTX_CMD_RAW_REPEAT,
-    SYNC_V1_H1,
-    HSTX_CMD_RAW_REPEAT,
-    SYNC_V1_H0,
-    HSTX_CMD_RAW_REPEAT,
-    SYNC_V1_H1,
-    HSTX_CMD_RAW | 6,
-    BLACK_PIXEL_A,
-    BLACK_PIXEL_B,
-    BLACK_PIXEL_A,
-    BLACK_PIXEL_B,
-    BLACK_PIXEL_A,
-    BLACK_PIXEL_B,
-    HSTX_CMD_TMDS
-};
-static uint32_t vactive_text_line_header[count_of(vactive_text_line_header_src)];
+// Text lines start with the same sync as other active lines, followed by
+// up to one character cell of black pixels where the character grid is
+// narrower than the display, so the length is set up in init.
+#define MAX_TEXT_LINE_PADDING 16
+static uint32_t vactive_text_line_header[count_of(vactive_line_header_src) + MAX_TEXT_LINE_PADDING + 1];
+static uint vactive_text_line_header_len;
+
+// Most byte or word copies applying a text update in one vsync.  Larger
+// updates, such as after a clear, continue over the following frames.
+#define MAX_TEXT_UPDATE_COPIES 512
 
 #define NUM_FRAME_LINES 2
 #define NUM_CHANS 3
 
 static DVHSTX* display = nullptr;
 
+static const DVHSTX::TextFont default_text_font = {14, 24, nullptr, 0, 0};
+
+// Resolutions available to text modes
+static const struct dvi_timing* const text_timings[] = {
+    &dvi_timing_1280x720p_rb_50hz,
+    &dvi_timing_640x480p_60hz,
+    &dvi_timing_720x480p_60hz,
+    &dvi_timing_720x400p_70hz,
+    &dvi_timing_720x576p_50hz,
+    &dvi_timing_800x600p_60hz,
+    &dvi_timing_800x480p_60hz,
+    &dvi_timing_800x450p_60hz,
+    &dvi_timing_960x540p_60hz,
+    &dvi_timing_1024x768_rb_60hz,
+    &dvi_timing_1920x1080p_rb2_30hz,
+};
+
 // ----------------------------------------------------------------------------
 // DMA logic
 
@@ -153,8 +485,8 @@ void __scratch_x("display") DVHSTX::gfx_dma_handler() {
         ch->read_addr = (uintptr_t)vblank_line_vsync_off;
         ch->transfer_count = count_of(vblank_line_vsync_off);
     } else {
-        const int y = (v_scanline - v_inactive_total) >> v_repeat_shift;
-        const int new_line_num = (v_repeat_shift == 0) ? ch_num : (y & (NUM_FRAME_LINES - 1));
+        const int display_y = (v_scanline - v_inactive_total) >> v_repeat_shift;
+        const int new_line_num = (v_repeat_shift == 0 || overlay_active) ? ch_num : (display_y & (NUM_FRAME_LINES - 1));
         const uint line_buf_total_len = ((timing_mode->h_active_pixels * line_bytes_per_pixel) >> 2) + count_of(vactive_line_header);
 
         ch->read_addr = (uintptr_t)&line_buffers[new_line_num * line_buf_total_len];
@@ -164,9 +496,93 @@ void __scratch_x("display") DVHSTX::gfx_dma_handler() {
         if (line_num != new_line_num)
         {
             line_num = new_line_num;
-            uint32_t* dst_ptr = &line_buffers[line_num * line_buf_total_len + count_of(vactive_line_header)];
+            uint32_t* const line_ptr = &line_buffers[line_num * line_buf_total_len + count_of(vactive_line_header)];
+            uint32_t* dst_ptr = line_ptr;
+
+            // Apply display list entries up to this line
+            while (display_list_pos < display_list_len && display_list[display_list_pos].line <= display_y) {
+                const DisplayListEntry& entry = display_list[display_list_pos++];
+                if (entry.action == DISPLAY_LIST_PALETTE) {
+                    display_palette[entry.index] = entry.value;
+                }
+                else if (entry.value < display_height) {
+                    scroll_offset = entry.value;
+                }
+            }
+
+            int y = display_y + scroll_offset;
+            if (y >= display_height) y -= display_height;
 
-            if (line_bytes_per_pixel == 2) {
+            if (is_tilemap) {
+                if (!tileset) {
+                    for (int i = 0; i < (timing_mode->h_active_pixels * line_bytes_per_pixel) >> 2; ++i) {
+                        *dst_ptr++ = 0;
+                    }
+                }
+                else {
+                    // Walk the row of the tile map, expanding the current line of each tile
+                    const int tile_size = 1 << tile_shift;
+                    const int tile_line_offset = (y & (tile_size - 1)) << tile_shift;
+                    const uint8_t* map_ptr = &frame_buffer_display[(y >> tile_shift) * frame_width];
+                    for (int x = 0; x < display_width; x += tile_size) {
+                        const int tile_offset = (*map_ptr++ << (tile_shift << 1)) + tile_line_offset;
+                        const int len = std::min(tile_size, display_width - x);
+
+                        if (line_bytes_per_pixel == 2) {
+                            const uint16_t* src_ptr = (const uint16_t*)tileset + tile_offset;
+                            if (h_repeat_shift == 2) {
+                                for (int i = 0; i < len; ++i) {
+                                    uint32_t val = (uint32_t)(*src_ptr++) * 0x10001;
+                                    *dst_ptr++ = val;
+                                    *dst_ptr++ = val;
+                                }
+                            }
+                            else {
+                                for (int i = 0; i < len; ++i) {
+                                    uint32_t val = (uint32_t)(*src_ptr++) * 0x10001;
+                                    *dst_ptr++ = val;
+                                }
+                            }
+                        }
+                        else {
+                            const uint8_t* src_ptr = tileset + tile_offset;
+                            if (h_repeat_shift == 2) {
+                                for (int i = 0; i < len; ++i) {
+                                    uint32_t val = display_palette[*src_ptr++];
+                                    *dst_ptr++ = val;
+                                    *dst_ptr++ = val;
+                                    *dst_ptr++ = val;
+                                    *dst_ptr++ = val;
+                                }
+                            }
+                            else {
+                                for (int i = 0; i < len; ++i) {
+                                    uint32_t val = display_palette[*src_ptr++];
+                                    *dst_ptr++ = val;
+                                    *dst_ptr++ = val;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            else if (mode == MODE_PALETTE_RGB565) {
+                // Palette entries hold the RGB565 colour in both halves of the word
+                uint8_t* src_ptr = &frame_buffer_display[y * (timing_mode->h_active_pixels >> h_repeat_shift)];
+                if (h_repeat_shift == 2) {
+                    for (int i = 0; i < timing_mode->h_active_pixels; i += 4) {
+                        uint32_t val = display_palette[*src_ptr++];
+                        *dst_ptr++ = val;
+                        *dst_ptr++ = val;
+                    }
+                }
+                else {
+                    for (int i = 0; i < timing_mode->h_active_pixels; i += 2) {
+                        *dst_ptr++ = display_palette[*src_ptr++];
+                    }
+                }
+            }
+            else if (line_bytes_per_pixel == 2) {
                 uint16_t* src_ptr = (uint16_t*)&frame_buffer_display[y * 2 * (timing_mode->h_active_pixels >> h_repeat_shift)];
                 if (h_repeat_shift == 2) {
                     for (int i = 0; i < timing_mode->h_active_pixels >> 1; i += 2) {
@@ -217,6 +633,10 @@ void __scratch_x("display") DVHSTX::gfx_dma_handler() {
                     }
                 }
             }
+
+            if (overlay_active) {
+                render_overlay_line(line_ptr, v_scanline - v_inactive_total);
+            }
         }
     }
 
@@ -225,12 +645,257 @@ void __scratch_x("display") DVHSTX::gfx_dma_handler() {
         line_num = -1;
         if (flip_next) {
             flip_next = false;
-            display->flip_now();
+            std::swap(frame_buffer_display, frame_buffer_back);
+        }
+        if (palette_flip_next) {
+            palette_flip_next = false;
+            std::swap(display_palette, display_palette_back);
+            carry_display_list_palette();
         }
+        if (display_list_flip_next) {
+            std::swap(display_list, display_list_back);
+            display_list_len = display_list_back_len;
+            display_list_back_len = 0;
+            display_list_flip_next = false;
+        }
+        display_list_pos = 0;
+        scroll_offset = 0;
+        overlay_active = overlay_enabled;
         __sev();
     }
 }
 
+// Palette entries set by the display list so far this frame are written to the
+// live palette, so copy them into a newly flipped in palette to persist them.
+void __not_in_flash("display") DVHSTX::carry_display_list_palette() {
+    for (int i = 0; i < display_list_pos; ++i) {
+        const DisplayListEntry& entry = display_list[i];
+        if (entry.action == DISPLAY_LIST_PALETTE) {
+            display_palette[entry.index] = entry.value;
+        }
+    }
+}
+
+void __scratch_x("display") DVHSTX::render_overlay_line(uint32_t* line, int y) {
+    const int row = y / text_cell_height;
+    if (row >= overlay_height || !overlay_row_used[row]) return;
+
+    const int char_y = y - row * text_cell_height;
+    const uint8_t first_glyph = text_first_glyph;
+    const uint8_t glyph_count = text_glyph_count;
+    const uint8_t* char_ptr = &overlay_chars[row * overlay_width];
+    const uint8_t* colour_ptr = &overlay_colours[row * overlay_width];
+
+    // Fully covered pixels are set to the text colour, half covered pixels are
+    // blended 50:50 with the background, and the rest are left as they are.
+    for (int x = 0; x < overlay_width; ++x) {
+        const uint8_t c = *char_ptr++ - first_glyph;
+        const uint8_t colour = *colour_ptr++;
+        if (c >= glyph_count) continue;
+
+        uint32_t bits = font_cache[char_y * (glyph_count + 1) + c];
+        if (!bits) continue;
+
+        if (line_bytes_per_pixel == 2) {
+            const uint16_t fg = ((colour & TEXT_RED) ? 0xF800 : 0) | ((colour & TEXT_GREEN) ? 0x07E0 : 0) | ((colour & TEXT_BLUE) ? 0x001F : 0);
+            const uint16_t fg_half = (fg >> 1) & 0x7BEF;
+            uint16_t* dst_ptr = (uint16_t*)line + x * text_cell_width;
+            for (int i = 0; i < text_cell_width; ++i) {
+                const uint32_t level = (bits >> ((24 - 2 * i) & 31)) & 3;
+                if (level == 3) dst_ptr[i] = fg;
+                else if (level == 2) dst_ptr[i] = ((dst_ptr[i] >> 1) & 0x7BEF) + fg_half;
+            }
+        }
+        else {
+            const uint32_t fg = ((colour & TEXT_RED) ? 0xFF0000 : 0) | ((colour & TEXT_GREEN) ? 0x00FF00 : 0) | ((colour & TEXT_BLUE) ? 0x0000FF : 0);
+            const uint32_t fg_half = (fg >> 1) & 0x7F7F7F;
+            uint32_t* dst_ptr = line + x * text_cell_width;
+            for (int i = 0; i < text_cell_width; ++i) {
+                const uint32_t level = (bits >> ((24 - 2 * i) & 31)) & 3;
+                if (level == 3) dst_ptr[i] = fg;
+                else if (level == 2) dst_ptr[i] = ((dst_ptr[i] >> 1) & 0x7F7F7F) + fg_half;
+            }
+        }
+    }
+}
+
+// Apply a cell's background and attributes.  Returns the colour to multiply
+// the pixel levels by, with base added to give the pixels: the difference
+// between foreground and background makes level 0 the background colour.
+// Attributes not in attr_mask are ignored for this line.
+static inline __attribute__((always_inline)) uint32_t text_cell_colour(uint32_t& bits, uint32_t& base, uint32_t colour, uint32_t attr,
+                                                                       uint32_t attr_mask, uint32_t underline_bits) {
+    uint32_t background = attr & DVHSTX::TEXT_WHITE;
+    if (attr & attr_mask) {
+        if (attr & attr_mask & DVHSTX::TEXT_UNDERLINE) bits = underline_bits;
+        if (attr & attr_mask & DVHSTX::TEXT_BLINK) bits = 0;
+        if (attr & DVHSTX::TEXT_INVERSE) std::swap(colour, background);
+    }
+    base = background * 0x03030303;
+    return colour - background;
+}
+
+// RGB111 text for cell widths other than 14 pixels
+void __not_in_flash("display") DVHSTX::render_text_line_rgb111(uint8_t* dst_ptr, const uint8_t* src_ptr, const uint32_t* font_line, uint32_t attr_mask) {
+    const uint8_t* colour_ptr = src_ptr + frame_width * frame_height;
+    const uint8_t* attr_ptr = colour_ptr + frame_width * frame_height;
+    const uint8_t first_glyph = text_first_glyph;
+    const uint8_t glyph_count = text_glyph_count;
+    const uint32_t underline_bits = text_underline_bits[0];
+
+    if ((text_cell_width & 3) == 0) {
+        // Whole words per character, 4 pixels at a time
+        uint32_t* dst_word = (uint32_t*)dst_ptr;
+        for (int i = 0; i < frame_width; ++i) {
+            const uint8_t c = (*src_ptr++ - first_glyph);
+            uint32_t bits = font_line[std::min(c, glyph_count)];
+            uint32_t base;
+            const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+
+            // Rotate so the first pixel is in the top bits
+            bits = (bits << 6) | (bits >> 26);
+            for (int j = 0; j < text_cell_width; j += 4, bits <<= 8) {
+                const uint32_t b = bits >> 24;
+                *dst_word++ = (((b >> 6) & 3) | (((b >> 4) & 3) << 8) | (((b >> 2) & 3) << 16) | ((b & 3) << 24)) * colour + base;
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < frame_width; ++i) {
+            const uint8_t c = (*src_ptr++ - first_glyph);
+            uint32_t bits = font_line[std::min(c, glyph_count)];
+            uint32_t base;
+            const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+
+            for (int j = 0; j < text_cell_width; ++j) {
+                *dst_ptr++ = colour * ((bits >> ((24 - 2 * j) & 31)) & 3) + base;
+            }
+        }
+    }
+}
+
+// Invert the part of the cursor cell covered by the cursor shape
+void __not_in_flash("display") DVHSTX::render_cursor(uint32_t* line) {
+    if (line_bytes_per_pixel == 4) {
+        line[cursor_x] ^= cursor_mono_bits;
+    }
+    else {
+        uint8_t* cell = (uint8_t*)line + cursor_x * text_cell_width;
+        for (int i = 0; i < cursor_columns; ++i) {
+            cell[i] ^= TEXT_WHITE * 3;
+        }
+    }
+}
+
+static inline __attribute__((always_inline)) uint32_t rotl32(uint32_t x, uint r) {
+    return (x << r) | (x >> ((32 - r) & 31));
+}
+
+// Move a rendered text line left by text_fine_x pixels, filling the right
+// hand end with blank pixels.
+void __not_in_flash("display") DVHSTX::shift_text_line(uint32_t* line, int words) {
+    if (line_bytes_per_pixel == 4) {
+        // One word per cell: pixels from the cell rotated into place, and the
+        // first text_fine_x pixels of the next cell after them.
+        const uint rot = 2 * text_fine_x;
+        const uint rot_next = (2 * (text_fine_x - text_cell_width)) & 31;
+        const uint32_t mask = text_fine_x_mask;
+        int i = 0;
+        for (; i < words - 1; ++i) {
+            line[i] = (rotl32(line[i], rot) & mask) | (rotl32(line[i + 1], rot_next) & ~mask);
+        }
+        line[i] = rotl32(line[i], rot) & mask;
+    }
+    else {
+        // One byte per pixel
+        const int offset = text_fine_x >> 2;
+        const int shift = (text_fine_x & 3) * 8;
+        int i = 0;
+        if (shift == 0) {
+            for (; i < words - offset; ++i) line[i] = line[i + offset];
+        }
+        else {
+            for (; i < words - offset - 1; ++i) line[i] = (line[i + offset] >> shift) | (line[i + offset + 1] << (32 - shift));
+            line[i] = line[i + offset] >> shift;
+            ++i;
+        }
+        for (; i < words; ++i) line[i] = 0;
+    }
+}
+
+// Copy dirty cells to the display buffer, up to MAX_TEXT_UPDATE_COPIES byte
+// or word copies per call so the vsync handler stays well within its deadline.
+// Returns true once every dirty cell has been copied.
+bool __not_in_flash("display") DVHSTX::apply_text_update() {
+    const uint32_t plane_size = frame_width * frame_height;
+    const uint32_t buffer_size = plane_size * frame_bytes_per_pixel;
+    const int dirty_words = (plane_size + 31) >> 5;
+    const bool word_aligned = (plane_size & 3) == 0;
+    int budget = MAX_TEXT_UPDATE_COPIES;
+
+    for (; text_update_word < dirty_words; ++text_update_word) {
+        const int i = text_update_word;
+        uint32_t bits = text_dirty[i];
+        if (!bits) continue;
+
+        // 32 dirty cells in a row are copied a word at a time
+        if (bits == 0xFFFFFFFF && word_aligned) {
+            const int cost = 8 * frame_bytes_per_pixel;
+            if (budget < cost) return false;
+            budget -= cost;
+            text_dirty[i] = 0;
+
+            for (uint32_t offset = i << 5; offset < buffer_size; offset += plane_size) {
+                uint32_t* dst = (uint32_t*)&frame_buffer_display[offset];
+                const uint32_t* src = (const uint32_t*)&frame_buffer_back[offset];
+                for (int j = 0; j < 8; ++j) dst[j] = src[j];
+            }
+            continue;
+        }
+
+        do {
+            if (budget < frame_bytes_per_pixel) {
+                text_dirty[i] = bits;
+                return false;
+            }
+            budget -= frame_bytes_per_pixel;
+
+            const uint32_t cell = (i << 5) + __builtin_ctz(bits);
+            bits &= bits - 1;
+            for (uint32_t offset = cell; offset < buffer_size; offset += plane_size) {
+                frame_buffer_display[offset] = frame_buffer_back[offset];
+            }
+        } while (bits);
+        text_dirty[i] = 0;
+    }
+
+    text_update_word = 0;
+    text_row_origin_display = text_row_origin_back;
+    return true;
+}
+
+void __scratch_x("display") dma_op_irq_handler() {
+    display->dma_op_handler();
+}
+
+void __not_in_flash("display") DVHSTX::dma_op_handler() {
+    // The IRQ is shared, so check this channel finished
+    if (dma_op_channel < 0 || !dma_irqn_get_channel_status(1, dma_op_channel)) return;
+    dma_irqn_acknowledge_channel(1, dma_op_channel);
+
+    if (--dma_op_rows_left == 0) {
+        dma_op_done = dma_op_started;
+        __sev();
+        return;
+    }
+
+    dma_op_write += dma_op_write_stride;
+    dma_op_read += dma_op_read_stride;
+    dma_channel_set_read_addr(dma_op_channel, (const void*)dma_op_read, false);
+    dma_channel_set_write_addr(dma_op_channel, (void*)dma_op_write, false);
+    dma_channel_set_trans_count(dma_op_channel, dma_op_count, true);
+}
+
 void __scratch_x("display") dma_irq_handler_text() {
     display->text_dma_handler();
 }
@@ -249,55 +914,164 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
         ch->read_addr = (uintptr_t)vblank_line_vsync_off;
         ch->transfer_count = count_of(vblank_line_vsync_off);
     } else {
-        const int y = (v_scanline - v_inactive_total);
-        const uint line_buf_total_len = (frame_width * line_bytes_per_pixel + 3) / 4 + count_of(vactive_text_line_header);
+        const int y = (v_scanline - v_inactive_total) + text_fine_y;
+        const uint line_buf_total_len = (frame_width * line_bytes_per_pixel + 3) / 4 + vactive_text_line_header_len;
 
         ch->read_addr = (uintptr_t)&line_buffers[ch_num * line_buf_total_len];
         ch->transfer_count = line_buf_total_len;
 
         // Fill line buffer
-        int char_y = y % 24;
-        if (line_bytes_per_pixel == 4) {
-            uint32_t* dst_ptr = &line_buffers[ch_num * line_buf_total_len + count_of(vactive_text_line_header)];
-            uint8_t* src_ptr = &frame_buffer_display[(y / 24) * frame_width];
-            for (int i = 0; i < frame_width; ++i) {
-                *dst_ptr++ = render_char_line(*src_ptr++, char_y);
+        const int char_row = y / text_cell_height;
+        const int char_y = y - char_row * text_cell_height;
+        const uint8_t first_glyph = text_first_glyph;
+        const uint8_t glyph_count = text_glyph_count;
+        const int font_cache_stride = glyph_count + 1;
+        const uint32_t* font_line = &font_cache[char_y * font_cache_stride];
+
+        int buffer_row = char_row + text_row_origin_display;
+        if (buffer_row >= frame_height) buffer_row -= frame_height;
+
+        // Inverse always applies, underline on one row of the cell, and blinking
+        // cells are hidden for half of each 64 frame cycle.
+        const uint32_t attr_mask = TEXT_INVERSE | ((char_y == text_underline_row) ? TEXT_UNDERLINE : 0) |
+                                   ((text_frame_count & 0x20) ? TEXT_BLINK : 0);
+        if (char_row >= frame_height) {
+            // Below the character grid
+            uint32_t* dst_ptr = &line_buffers[ch_num * line_buf_total_len + vactive_text_line_header_len];
+            for (uint i = vactive_text_line_header_len; i < line_buf_total_len; ++i) {
+                *dst_ptr++ = 0;
+            }
+        }
+        else if (line_bytes_per_pixel == 4) {
+            uint32_t* dst_ptr = &line_buffers[ch_num * line_buf_total_len + vactive_text_line_header_len];
+            const uint8_t* src_ptr = &frame_buffer_display[buffer_row * frame_width];
+            int i = 0;
+#if defined(__riscv)
+            // With Zbb the clamp is a minu and the lookup a sh2add, and Hazard3
+            // can't load unaligned words, so characters are loaded singly.
+            for (; i < frame_width - 3; i += 4) {
+                const uint8_t c0 = src_ptr[0] - first_glyph;
+                const uint8_t c1 = src_ptr[1] - first_glyph;
+                const uint8_t c2 = src_ptr[2] - first_glyph;
+                const uint8_t c3 = src_ptr[3] - first_glyph;
+                dst_ptr[0] = font_line[std::min(c0, glyph_count)];
+                dst_ptr[1] = font_line[std::min(c1, glyph_count)];
+                dst_ptr[2] = font_line[std::min(c2, glyph_count)];
+                dst_ptr[3] = font_line[std::min(c3, glyph_count)];
+                src_ptr += 4;
+                dst_ptr += 4;
+            }
+#else
+            // Four characters per (unaligned) word load.  usub8 subtracts the first
+            // glyph from each byte, then usub8 and sel clamp each to glyph_count,
+            // so characters outside the font use the blank glyph.
+            const uint32_t first_glyph4 = first_glyph * 0x01010101u;
+            const uint32_t glyph_count4 = glyph_count * 0x01010101u;
+            for (; i < frame_width - 3; i += 4) {
+                uint32_t chars, tmp;
+                memcpy(&chars, src_ptr, 4);
+                asm (
+                    "usub8 %[chars], %[chars], %[first]\n\t"
+                    "usub8 %[tmp], %[chars], %[count]\n\t"
+                    "sel %[chars], %[count], %[chars]\n\t"
+                    : [chars] "+r" (chars), [tmp] "=&r" (tmp)
+                    : [first] "r" (first_glyph4), [count] "r" (glyph_count4)
+                    : "cc"
+                );
+                dst_ptr[0] = font_line[chars & 0xFF];
+                dst_ptr[1] = font_line[(chars >> 8) & 0xFF];
+                dst_ptr[2] = font_line[(chars >> 16) & 0xFF];
+                dst_ptr[3] = font_line[chars >> 24];
+                src_ptr += 4;
+                dst_ptr += 4;
+            }
+#endif
+            for (; i < frame_width; ++i) {
+                const uint8_t c = *src_ptr++ - first_glyph;
+                *dst_ptr++ = font_line[std::min(c, glyph_count)];
             }
         }
+        else if (text_cell_width != 14) {
+            render_text_line_rgb111((uint8_t*)&line_buffers[ch_num * line_buf_total_len + vactive_text_line_header_len],
+                                    &frame_buffer_display[buffer_row * frame_width], font_line, attr_mask);
+        }
         else {
-            uint8_t* dst_ptr = (uint8_t*)&line_buffers[ch_num * line_buf_total_len + count_of(vactive_text_line_header)];
-            uint8_t* src_ptr = &frame_buffer_display[(y / 24) * frame_width];
+            uint8_t* dst_ptr = (uint8_t*)&line_buffers[ch_num * line_buf_total_len + vactive_text_line_header_len];
+            uint8_t* src_ptr = &frame_buffer_display[buffer_row * frame_width];
             uint8_t* colour_ptr = src_ptr + frame_width * frame_height;
-#ifdef __riscv
+            uint8_t* attr_ptr = colour_ptr + frame_width * frame_height;
+#if defined(TEXT_RGB111_ZIP)
+            // Each pair of characters is 28 pixels, or 7 words.  The second character
+            // of the pair comes from a copy of the cache offset by 2 pixels.
+            const uint32_t* font_line_odd = font_line + text_cell_height * font_cache_stride;
+            constexpr uint32_t mask = 0x03030303;
+            uint32_t* dst_word = (uint32_t*)dst_ptr;
+            int i = 0;
+            const uint32_t underline_bits = text_underline_bits[0];
+            const uint32_t underline_bits_odd = text_underline_bits[1];
+            for (; i < frame_width-1; i += 2) {
+                uint8_t c = (*src_ptr++ - first_glyph);
+                uint32_t bits = font_line[std::min(c, glyph_count)];
+                uint32_t base, base2;
+                const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+                c = (*src_ptr++ - first_glyph);
+                uint32_t bits2 = font_line_odd[std::min(c, glyph_count)];
+                const uint32_t colour2 = text_cell_colour(bits2, base2, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits_odd);
+
+                dst_word[0] = (zip(bits) & mask) * colour + base;
+                dst_word[1] = (zip(bits >> 1) & mask) * colour + base;
+                dst_word[2] = (zip(bits >> 2) & mask) * colour + base;
+                dst_word[3] = (((zip(bits >> 3) & mask) * colour + base) & 0xFFFF) | (((zip(bits2) & mask) * colour2 + base2) & 0xFFFF0000);
+                dst_word[4] = (zip(bits2 >> 1) & mask) * colour2 + base2;
+                dst_word[5] = (zip(bits2 >> 2) & mask) * colour2 + base2;
+                dst_word[6] = (zip(bits2 >> 3) & mask) * colour2 + base2;
+                dst_word += 7;
+            }
+            if (i != frame_width) {
+                const uint8_t c = (*src_ptr++ - first_glyph);
+                uint32_t bits = font_line[std::min(c, glyph_count)];
+                uint32_t base;
+                const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+
+                dst_word[0] = (zip(bits) & mask) * colour + base;
+                dst_word[1] = (zip(bits >> 1) & mask) * colour + base;
+                dst_word[2] = (zip(bits >> 2) & mask) * colour + base;
+                *(uint16_t*)&dst_word[3] = (zip(bits >> 3) & mask) * colour + base;
+            }
+#elif defined(__riscv)
+            const uint32_t underline_bits = text_underline_bits[0];
             for (int i = 0; i < frame_width; ++i) {
-                const uint8_t c = (*src_ptr++ - FIRST_GLYPH);
-                uint32_t bits = (c < GLYPH_COUNT) ? font_cache[c * 24 + char_y] : 0;
-                const uint8_t colour = *colour_ptr++;
-
-                *dst_ptr++ = colour * ((bits >> 24) & 3);
-                *dst_ptr++ = colour * ((bits >> 22) & 3);
-                *dst_ptr++ = colour * ((bits >> 20) & 3);
-                *dst_ptr++ = colour * ((bits >> 18) & 3);
-                *dst_ptr++ = colour * ((bits >> 16) & 3);
-                *dst_ptr++ = colour * ((bits >> 14) & 3);
-                *dst_ptr++ = colour * ((bits >> 12) & 3);
-                *dst_ptr++ = colour * ((bits >> 10) & 3);
-                *dst_ptr++ = colour * ((bits >> 8) & 3);
-                *dst_ptr++ = colour * ((bits >> 6) & 3);
-                *dst_ptr++ = colour * ((bits >> 4) & 3);
-                *dst_ptr++ = colour * ((bits >> 2) & 3);
-                *dst_ptr++ = colour * (bits & 3);
-                *dst_ptr++ = 0;
+                const uint8_t c = (*src_ptr++ - first_glyph);
+                uint32_t bits = font_line[std::min(c, glyph_count)];
+                uint32_t base;
+                const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+
+                *dst_ptr++ = colour * ((bits >> 24) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 22) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 20) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 18) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 16) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 14) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 12) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 10) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 8) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 6) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 4) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 2) & 3) + base;
+                *dst_ptr++ = colour * (bits & 3) + base;
+                *dst_ptr++ = colour * (bits >> 30) + base;
             }
 #else
+            const uint32_t underline_bits = text_underline_bits[0];
             int i = 0;
             for (; i < frame_width-1; i += 2) {
-                uint8_t c = (*src_ptr++ - FIRST_GLYPH);
-                uint32_t bits = (c < GLYPH_COUNT) ? font_cache[c * 24 + char_y] : 0;
-                uint8_t colour = *colour_ptr++;
-                c = (*src_ptr++ - FIRST_GLYPH);
-                uint32_t bits2 = (c < GLYPH_COUNT) ? font_cache[c * 24 + char_y] : 0;
-                uint8_t colour2 = *colour_ptr++;
+                uint8_t c = (*src_ptr++ - first_glyph);
+                uint32_t bits = font_line[std::min(c, glyph_count)];
+                uint32_t base, base2;
+                const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+                c = (*src_ptr++ - first_glyph);
+                uint32_t bits2 = font_line[std::min(c, glyph_count)];
+                const uint32_t colour2 = text_cell_colour(bits2, base2, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
 
                 // This ASM works around a compiler bug where the optimizer decides
                 // to unroll so hard it spills to the stack.
@@ -310,7 +1084,7 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
                     "bfi %[tmp], %[tmp2], #16, #8\n\t"
                     "ubfx %[tmp2], %[cbits], #18, #2\n\t"
                     "bfi %[tmp], %[tmp2], #24, #8\n\t"
-                    "muls %[tmp], %[colour], %[tmp]\n\t"
+                    "mla %[tmp], %[colour], %[tmp], %[base]\n\t"
                     "str %[tmp], [%[dst_ptr]]\n\t"
 
                     "ubfx %[tmp], %[cbits], #16, #2\n\t"
@@ -320,7 +1094,7 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
                     "bfi %[tmp], %[tmp2], #16, #8\n\t"
                     "ubfx %[tmp2], %[cbits], #10, #2\n\t"
                     "bfi %[tmp], %[tmp2], #24, #8\n\t"
-                    "muls %[tmp], %[colour], %[tmp]\n\t"
+                    "mla %[tmp], %[colour], %[tmp], %[base]\n\t"
                     "str %[tmp], [%[dst_ptr], #4]\n\t"
 
                     "ubfx %[tmp], %[cbits], #8, #2\n\t"
@@ -330,17 +1104,19 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
                     "bfi %[tmp], %[tmp2], #16, #8\n\t"
                     "ubfx %[tmp2], %[cbits], #2, #2\n\t"
                     "bfi %[tmp], %[tmp2], #24, #8\n\t"
-                    "muls %[tmp], %[colour], %[tmp]\n\t"
+                    "mla %[tmp], %[colour], %[tmp], %[base]\n\t"
                     "str %[tmp], [%[dst_ptr], #8]\n\t"
 
+                    "and %[tmp], %[cbits], #3\n\t"
+                    "lsrs %[tmp2], %[cbits], #30\n\t"
+                    "bfi %[tmp], %[tmp2], #8, #8\n\t"
+                    "mla %[tmp], %[colour], %[tmp], %[base]\n\t"
+                    "strh %[tmp], [%[dst_ptr], #12]\n\t"
                     "ubfx %[tmp], %[cbits2], #24, #2\n\t"
                     "ubfx %[tmp2], %[cbits2], #22, #2\n\t"
                     "bfi %[tmp], %[tmp2], #8, #8\n\t"
-                    "muls %[tmp], %[colour2], %[tmp]\n\t"
-                    "and %[tmp2], %[cbits], #3\n\t"
-                    "muls %[tmp2], %[colour], %[tmp2]\n\t"
-                    "bfi %[tmp2], %[tmp], #16, #16\n\t"
-                    "str %[tmp2], [%[dst_ptr], #12]\n\t"
+                    "mla %[tmp], %[colour2], %[tmp], %[base2]\n\t"
+                    "strh %[tmp], [%[dst_ptr], #14]\n\t"
 
                     "ubfx %[tmp], %[cbits2], #20, #2\n\t"
                     "ubfx %[tmp2], %[cbits2], #18, #2\n\t"
@@ -349,7 +1125,7 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
                     "bfi %[tmp], %[tmp2], #16, #8\n\t"
                     "ubfx %[tmp2], %[cbits2], #14, #2\n\t"
                     "bfi %[tmp], %[tmp2], #24, #8\n\t"
-                    "muls %[tmp], %[colour2], %[tmp]\n\t"
+                    "mla %[tmp], %[colour2], %[tmp], %[base2]\n\t"
                     "str %[tmp], [%[dst_ptr], #16]\n\t"
 
                     "ubfx %[tmp], %[cbits2], #12, #2\n\t"
@@ -359,47 +1135,62 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
                     "bfi %[tmp], %[tmp2], #16, #8\n\t"
                     "ubfx %[tmp2], %[cbits2], #6, #2\n\t"
                     "bfi %[tmp], %[tmp2], #24, #8\n\t"
-                    "muls %[tmp], %[colour2], %[tmp]\n\t"
+                    "mla %[tmp], %[colour2], %[tmp], %[base2]\n\t"
                     "str %[tmp], [%[dst_ptr], #20]\n\t"
 
                     "ubfx %[tmp], %[cbits2], #4, #2\n\t"
                     "ubfx %[tmp2], %[cbits2], #2, #2\n\t"
                     "bfi %[tmp], %[tmp2], #8, #8\n\t"
                     "bfi %[tmp], %[cbits2], #16, #2\n\t"
-                    "muls %[tmp], %[colour2], %[tmp]\n\t"
+                    "lsrs %[tmp2], %[cbits2], #30\n\t"
+                    "bfi %[tmp], %[tmp2], #24, #8\n\t"
+                    "mla %[tmp], %[colour2], %[tmp], %[base2]\n\t"
                     "str %[tmp], [%[dst_ptr], #24]\n\t"
-                    : [tmp] "=&l" (tmp),
-                      [tmp2] "=&l" (tmp2)
+                    : [tmp] "=&r" (tmp),
+                      [tmp2] "=&r" (tmp2)
                     : [cbits] "r" (bits),
-                      [colour] "l" (colour),
+                      [colour] "r" (colour),
+                      [base] "r" (base),
                       [cbits2] "r" (bits2),
-                      [colour2] "l" (colour2),
+                      [colour2] "r" (colour2),
+                      [base2] "r" (base2),
                       [dst_ptr] "r" (dst_ptr)
                     : "cc", "memory" );
                 dst_ptr += 14 * 2;                
             }
             if (i != frame_width) {
-                const uint8_t c = (*src_ptr++ - FIRST_GLYPH);
-                uint32_t bits = (c < GLYPH_COUNT) ? font_cache[c * 24 + char_y] : 0;
-                const uint8_t colour = *colour_ptr++;
-
-                *dst_ptr++ = colour * ((bits >> 24) & 3);
-                *dst_ptr++ = colour * ((bits >> 22) & 3);
-                *dst_ptr++ = colour * ((bits >> 20) & 3);
-                *dst_ptr++ = colour * ((bits >> 18) & 3);
-                *dst_ptr++ = colour * ((bits >> 16) & 3);
-                *dst_ptr++ = colour * ((bits >> 14) & 3);
-                *dst_ptr++ = colour * ((bits >> 12) & 3);
-                *dst_ptr++ = colour * ((bits >> 10) & 3);
-                *dst_ptr++ = colour * ((bits >> 8) & 3);
-                *dst_ptr++ = colour * ((bits >> 6) & 3);
-                *dst_ptr++ = colour * ((bits >> 4) & 3);
-                *dst_ptr++ = colour * ((bits >> 2) & 3);
-                *dst_ptr++ = colour * (bits & 3);
-                *dst_ptr++ = 0;
+                const uint8_t c = (*src_ptr++ - first_glyph);
+                uint32_t bits = font_line[std::min(c, glyph_count)];
+                uint32_t base;
+                const uint32_t colour = text_cell_colour(bits, base, *colour_ptr++, *attr_ptr++, attr_mask, underline_bits);
+
+                *dst_ptr++ = colour * ((bits >> 24) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 22) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 20) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 18) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 16) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 14) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 12) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 10) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 8) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 6) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 4) & 3) + base;
+                *dst_ptr++ = colour * ((bits >> 2) & 3) + base;
+                *dst_ptr++ = colour * (bits & 3) + base;
+                *dst_ptr++ = colour * (bits >> 30) + base;
             }
 #endif
         }
+
+        if (cursor_visible && char_row == cursor_y && char_y >= cursor_first_row && char_y <= cursor_last_row &&
+            (uint)cursor_x < (uint)frame_width) {
+            render_cursor(&line_buffers[ch_num * line_buf_total_len + vactive_text_line_header_len]);
+        }
+
+        if (text_fine_x && char_row < frame_height) {
+            shift_text_line(&line_buffers[ch_num * line_buf_total_len + vactive_text_line_header_len],
+                            line_buf_total_len - vactive_text_line_header_len);
+        }
     }
 
     if (++v_scanline == v_total_active_lines) {
@@ -407,7 +1198,24 @@ void __scratch_x("display") DVHSTX::text_dma_handler() {
         line_num = -1;
         if (flip_next) {
             flip_next = false;
-            display->flip_now();
+            std::swap(frame_buffer_display, frame_buffer_back);
+            std::swap(text_row_origin_display, text_row_origin_back);
+        }
+        if (palette_flip_next) {
+            // The palette isn't used in text modes, but the flip must still complete
+            palette_flip_next = false;
+            std::swap(display_palette, display_palette_back);
+        }
+        if (text_update_next && apply_text_update()) {
+            text_update_next = false;
+        }
+        text_fine_x = text_fine_x_next;
+        text_fine_x_mask = text_fine_x_mask_next;
+        text_fine_y = text_fine_y_next;
+        ++text_frame_count;
+        if (cursor_blink_frames && ++cursor_blink_count >= cursor_blink_frames) {
+            cursor_blink_count = 0;
+            cursor_visible = !cursor_visible && cursor_shape != CURSOR_NONE;
         }
         __sev();
     }
@@ -510,6 +1318,54 @@ namespace {
 }
 #endif
 
+bool DVHSTX::build_font_cache() {
+    // Need to pre-render the font to RAM to be fast enough.
+    const TextFont& font = text_font ? *text_font : default_text_font;
+    const int font_cache_stride = text_glyph_count + 1;
+
+    // Underlined cells show a solid line in place of the glyph
+    uint32_t underline_bits = 0;
+    for (int x = 0; x < text_cell_width; ++x) underline_bits |= pack_char_pixel(x, 3);
+    text_underline_bits[0] = underline_bits;
+    text_underline_bits[1] = underline_bits;
+
+#ifdef TEXT_RGB111_ZIP
+    if (mode == MODE_TEXT_RGB111 && text_cell_width == 14) {
+        // Even and odd character caches, see zip_char_line
+        font_cache = (uint32_t*)malloc(4 * 2 * text_cell_height * font_cache_stride);
+        if (!font_cache) return false;
+
+        text_underline_bits[0] = zip_char_line(underline_bits, 0);
+        text_underline_bits[1] = zip_char_line(underline_bits, 2);
+
+        uint32_t* font_cache_ptr = font_cache;
+        uint32_t* font_cache_odd_ptr = font_cache + text_cell_height * font_cache_stride;
+        for (int y = 0; y < text_cell_height; ++y) {
+            for (int c = 0; c < text_glyph_count; ++c) {
+                const uint32_t bits = generate_char_line(font, text_charset, c + text_first_glyph, y);
+                *font_cache_ptr++ = zip_char_line(bits, 0);
+                *font_cache_odd_ptr++ = zip_char_line(bits, 2);
+            }
+            *font_cache_ptr++ = 0;
+            *font_cache_odd_ptr++ = 0;
+        }
+        return true;
+    }
+#endif
+
+    font_cache = (uint32_t*)malloc(4 * text_cell_height * font_cache_stride);
+    if (!font_cache) return false;
+
+    uint32_t* font_cache_ptr = font_cache;
+    for (int y = 0; y < text_cell_height; ++y) {
+        for (int c = 0; c < text_glyph_count; ++c) {
+            *font_cache_ptr++ = generate_char_line(font, text_charset, c + text_first_glyph, y);
+        }
+        *font_cache_ptr++ = 0;
+    }
+    return true;
+}
+
 void DVHSTX::display_setup_clock() {
     const uint32_t dvi_clock_khz = timing_mode->bit_clk_khz >> 1;
     uint vco_freq, post_div1, post_div2;
@@ -541,35 +1397,182 @@ void DVHSTX::display_setup_clock() {
 
 void DVHSTX::write_pixel(const Point &p, uint16_t colour)
 {
+    if (is_tilemap) return;
     *point_to_ptr16(p) = colour;
 }
 
 void DVHSTX::write_pixel_span(const Point &p, uint l, uint16_t colour)
 {
+    if (is_tilemap) return;
     uint16_t* ptr = point_to_ptr16(p);
-    for (uint i = 0; i < l; ++i) ptr[i] = colour;
+    if (l && ((uintptr_t)ptr & 2)) {
+        *ptr++ = colour;
+        --l;
+    }
+
+    // Write 8 pixels per iteration as pairs of words, which the compiler
+    // can turn into double word stores.
+    uint32_t* pair_ptr = (uint32_t*)ptr;
+    const uint32_t pair = colour * 0x10001;
+    for (; l >= 8; l -= 8) {
+        pair_ptr[0] = pair;
+        pair_ptr[1] = pair;
+        pair_ptr[2] = pair;
+        pair_ptr[3] = pair;
+        pair_ptr += 4;
+    }
+    for (; l >= 2; l -= 2) *pair_ptr++ = pair;
+
+    if (l) *(uint16_t*)pair_ptr = colour;
 }
 
+// The copies use memcpy, which copies by word when the source and
+// destination alignment allows and handles the ends.
 void DVHSTX::write_pixel_span(const Point &p, uint l, uint16_t *data)
 {
-    uint16_t* ptr = point_to_ptr16(p);
-    for (uint i = 0; i < l; ++i) ptr[i] = data[i];
+    if (is_tilemap) return;
+    memcpy(point_to_ptr16(p), data, l * sizeof(uint16_t));
 }
 
 void DVHSTX::read_pixel_span(const Point &p, uint l, uint16_t *data)
 {
-    const uint16_t* ptr = point_to_ptr16(p);
-    for (uint i = 0; i < l; ++i) data[i] = ptr[i];
+    if (is_tilemap) return;
+    memcpy(data, point_to_ptr16(p), l * sizeof(uint16_t));
+}
+
+// RGB565 blending works on the channels spread out with gaps between them, so
+// each channel can be scaled by a 5 bit alpha with one multiply.  A pair of
+// pixels in a word is split into two such groups: pixel 0 red and blue with
+// pixel 1 green (RGB565_PAIR_MASK_A), and pixel 0 green with pixel 1 red and
+// blue, shifted down 5 bits (RGB565_PAIR_MASK_B).  A single pixel uses its
+// value in both halves of a word with RGB565_PAIR_MASK_A.
+static constexpr uint32_t RGB565_PAIR_MASK_A = 0x07E0F81F;
+static constexpr uint32_t RGB565_PAIR_MASK_B = 0x07C0F83F;
+
+static inline uint32_t blend_rgb565_pixel(uint16_t dst, uint32_t colour_spread, uint32_t alpha) {
+    const uint32_t dst_spread = (dst | ((uint32_t)dst << 16)) & RGB565_PAIR_MASK_A;
+    const uint32_t blended = ((dst_spread * (32 - alpha) + colour_spread * alpha) >> 5) & RGB565_PAIR_MASK_A;
+    return (uint16_t)(blended | (blended >> 16));
+}
+
+void DVHSTX::blend_pixel_span(const Point &p, uint l, uint16_t colour, uint8_t alpha)
+{
+    if (is_tilemap) return;
+    // 0-255 to 0-32
+    const uint32_t a = (alpha + 4) >> 3;
+    if (a == 0) return;
+    if (a == 32) {
+        write_pixel_span(p, l, colour);
+        return;
+    }
+
+    const uint32_t colour_pair = colour | ((uint32_t)colour << 16);
+    const uint32_t colour_a = (colour_pair & RGB565_PAIR_MASK_A) * a;
+    const uint32_t colour_b = ((colour_pair >> 5) & RGB565_PAIR_MASK_B) * a;
+    const uint32_t dst_alpha = 32 - a;
+
+    uint16_t* ptr = point_to_ptr16(p);
+    if (l && ((uintptr_t)ptr & 2)) {
+        *ptr = blend_rgb565_pixel(*ptr, colour_pair & RGB565_PAIR_MASK_A, a);
+        ++ptr;
+        --l;
+    }
+
+    uint32_t* pair_ptr = (uint32_t*)ptr;
+    for (; l >= 2; l -= 2) {
+        const uint32_t dst = *pair_ptr;
+        const uint32_t blended_a = (((dst & RGB565_PAIR_MASK_A) * dst_alpha + colour_a) >> 5) & RGB565_PAIR_MASK_A;
+        const uint32_t blended_b = ((((dst >> 5) & RGB565_PAIR_MASK_B) * dst_alpha + colour_b) >> 5) & RGB565_PAIR_MASK_B;
+        *pair_ptr++ = blended_a | (blended_b << 5);
+    }
+
+    if (l) {
+        ptr = (uint16_t*)pair_ptr;
+        *ptr = blend_rgb565_pixel(*ptr, colour_pair & RGB565_PAIR_MASK_A, a);
+    }
+}
+
+void DVHSTX::blend_pixel_span(const Point &p, uint l, uint16_t colour, const uint8_t* alpha)
+{
+    if (is_tilemap) return;
+    const uint32_t colour_pair = colour | ((uint32_t)colour << 16);
+    const uint32_t colour_spread = colour_pair & RGB565_PAIR_MASK_A;
+
+    uint16_t* ptr = point_to_ptr16(p);
+    if (l && ((uintptr_t)ptr & 2)) {
+        const uint32_t a = (*alpha++ + 4) >> 3;
+        if (a) *ptr = blend_rgb565_pixel(*ptr, colour_spread, a);
+        ++ptr;
+        --l;
+    }
+
+    // Each pixel of a pair has its own alpha, so the pixels are blended
+    // separately, in the single pixel spread form, but loaded and stored
+    // together.  Fully transparent or opaque pairs, the common case at the
+    // edges of anti-aliased shapes, skip the blend.
+    uint32_t* pair_ptr = (uint32_t*)ptr;
+    for (; l >= 2; l -= 2, alpha += 2, ++pair_ptr) {
+        const uint32_t a0 = (alpha[0] + 4) >> 3;
+        const uint32_t a1 = (alpha[1] + 4) >> 3;
+        if ((a0 | a1) == 0) continue;
+        if ((a0 & a1) == 32) {
+            *pair_ptr = colour_pair;
+            continue;
+        }
+
+        const uint32_t dst = *pair_ptr;
+        *pair_ptr = blend_rgb565_pixel(dst, colour_spread, a0) |
+                    (blend_rgb565_pixel(dst >> 16, colour_spread, a1) << 16);
+    }
+
+    if (l) {
+        const uint32_t a = (*alpha + 4) >> 3;
+        ptr = (uint16_t*)pair_ptr;
+        if (a) *ptr = blend_rgb565_pixel(*ptr, colour_spread, a);
+    }
 }
 
 void DVHSTX::set_palette(RGB888 new_palette[PALETTE_SIZE])
 {
     memcpy(palette, new_palette, PALETTE_SIZE * sizeof(RGB888));
+    palette_dirty = true;
+    ++palette_generation;
 }
 
 void DVHSTX::set_palette_colour(uint8_t entry, RGB888 colour)
 {
     palette[entry] = colour;
+    palette_dirty = true;
+    ++palette_generation;
+}
+
+void DVHSTX::rotate_palette(uint8_t first, uint count, int n)
+{
+    count = std::min(count, (uint)PALETTE_SIZE - first);
+    if (count < 2) return;
+
+    n %= (int)count;
+    if (n < 0) n += count;
+    if (n == 0) return;
+
+    std::rotate(&palette[first], &palette[first + count - n], &palette[first + count]);
+    palette_dirty = true;
+    ++palette_generation;
+}
+
+void DVHSTX::prepare_palette()
+{
+    while (palette_flip_next) __wfe();
+    for (int i = 0; i < PALETTE_SIZE; ++i) {
+        display_palette_back[i] = display_palette_entry(palette[i]);
+    }
+    palette_dirty = false;
+}
+
+void DVHSTX::flip_palette()
+{
+    prepare_palette();
+    palette_flip_next = true;
 }
 
 RGB888* DVHSTX::get_palette()
@@ -579,38 +1582,539 @@ RGB888* DVHSTX::get_palette()
 
 void DVHSTX::write_palette_pixel(const Point &p, uint8_t colour)
 {
+    if (is_tilemap) return;
     *point_to_ptr_palette(p) = colour;
 }
 
 void DVHSTX::write_palette_pixel_span(const Point &p, uint l, uint8_t colour)
 {
+    if (is_tilemap) return;
     uint8_t* ptr = point_to_ptr_palette(p);
     memset(ptr, colour, l);
 }
 
 void DVHSTX::write_palette_pixel_span(const Point &p, uint l, uint8_t* data)
 {
+    if (is_tilemap) return;
     uint8_t* ptr = point_to_ptr_palette(p);
     memcpy(ptr, data, l);
 }
 
 void DVHSTX::read_palette_pixel_span(const Point &p, uint l, uint8_t *data)
 {
+    if (is_tilemap) return;
     const uint8_t* ptr = point_to_ptr_palette(p);
     memcpy(data, ptr, l);
 }
 
+uint32_t DVHSTX::start_dma_op(uint8_t* write, uint32_t write_stride, const uint8_t* read, uint32_t read_stride,
+                              uint32_t fill, uint32_t row_bytes, uint32_t rows)
+{
+    // Only one operation runs at a time
+    wait_for_dma();
+    const uint32_t handle = dma_op_started + 1;
+
+    if (row_bytes == 0) rows = 0;
+
+    // Contiguous rows can be done in one transfer
+    if (rows > 1 && write_stride == row_bytes && (!read || read_stride == row_bytes)) {
+        row_bytes *= rows;
+        rows = 1;
+    }
+
+    // Use the largest transfer size the addresses and lengths allow
+    uint32_t align = (uintptr_t)write | row_bytes | (rows > 1 ? write_stride : 0);
+    if (read) align |= (uintptr_t)read | (rows > 1 ? read_stride : 0);
+    const uint size_shift = (align & 1) ? 0 : (align & 2) ? 1 : 2;
+
+    if (rows == 0 || dma_op_channel < 0) {
+        for (; rows > 0; --rows, write += write_stride) {
+            if (read) {
+                memcpy(write, read, row_bytes);
+                read += read_stride;
+            }
+            else if (size_shift == 0) memset(write, fill, row_bytes);
+            else if (size_shift == 1) std::fill_n((uint16_t*)write, row_bytes >> 1, (uint16_t)fill);
+            else std::fill_n((uint32_t*)write, row_bytes >> 2, fill);
+        }
+        dma_op_started = handle;
+        dma_op_done = handle;
+        return handle;
+    }
+
+    // Fills read the low bytes of dma_op_fill repeatedly
+    dma_op_fill = fill;
+    dma_op_read = read ? (uintptr_t)read : (uintptr_t)&dma_op_fill;
+    dma_op_write = (uintptr_t)write;
+    dma_op_read_stride = read ? read_stride : 0;
+    dma_op_write_stride = write_stride;
+    dma_op_count = row_bytes >> size_shift;
+    dma_op_rows_left = rows;
+    dma_op_started = handle;
+
+    dma_channel_config c = dma_channel_get_default_config(dma_op_channel);
+    channel_config_set_transfer_data_size(&c, (dma_channel_transfer_size)size_shift);
+    channel_config_set_read_increment(&c, read != nullptr);
+    channel_config_set_write_increment(&c, true);
+    dma_channel_configure(dma_op_channel, &c, (void*)dma_op_write, (const void*)dma_op_read, dma_op_count, true);
+
+    return handle;
+}
+
+uint32_t DVHSTX::clear_async()
+{
+    const uint32_t len = frame_width * frame_height * frame_bytes_per_pixel;
+    const uint32_t handle = start_dma_op(frame_buffer_back, len, nullptr, 0, 0, len, 1);
+    text_row_origin_back = 0;
+    mark_text_dirty(0, frame_width * frame_height);
+    return handle;
+}
+
+uint32_t DVHSTX::fill_rect_async(const Rect &r, uint16_t colour)
+{
+    const Rect clipped = r.intersection(Rect(0, 0, frame_width, frame_height));
+    if (clipped.empty() || frame_bytes_per_pixel > 2) return start_dma_op(nullptr, 0, nullptr, 0, 0, 0, 0);
+
+    const uint32_t stride = frame_width * frame_bytes_per_pixel;
+    const uint32_t fill = (frame_bytes_per_pixel == 1) ? (colour & 0xFF) * 0x01010101 : colour * 0x10001;
+    return start_dma_op(frame_buffer_back + clipped.y * stride + clipped.x * frame_bytes_per_pixel, stride,
+                        nullptr, 0, fill, clipped.w * frame_bytes_per_pixel, clipped.h);
+}
+
+uint32_t DVHSTX::copy_rect_async(const Rect &r, const void* src, uint src_stride)
+{
+    const Rect clipped = r.intersection(Rect(0, 0, frame_width, frame_height));
+    if (clipped.empty() || frame_bytes_per_pixel > 2) return start_dma_op(nullptr, 0, nullptr, 0, 0, 0, 0);
+
+    const uint32_t stride = frame_width * frame_bytes_per_pixel;
+    const uint8_t* src_ptr = (const uint8_t*)src + ((clipped.y - r.y) * src_stride + (clipped.x - r.x)) * frame_bytes_per_pixel;
+    return start_dma_op(frame_buffer_back + clipped.y * stride + clipped.x * frame_bytes_per_pixel, stride,
+                        src_ptr, src_stride * frame_bytes_per_pixel, 0, clipped.w * frame_bytes_per_pixel, clipped.h);
+}
+
+uint32_t DVHSTX::copy_async(void* dst, const void* src, uint32_t len)
+{
+    return start_dma_op((uint8_t*)dst, len, (const uint8_t*)src, len, 0, len, 1);
+}
+
+void DVHSTX::wait_for_dma(uint32_t handle)
+{
+    while (!is_dma_done(handle)) __wfe();
+}
+
+static constexpr std::array<uint16_t, 256> make_rgb332_to_rgb565() {
+    std::array<uint16_t, 256> lut = {};
+    for (int i = 0; i < 256; ++i) {
+        const uint r = i >> 5;
+        const uint g = (i >> 2) & 7;
+        const uint b = i & 3;
+        lut[i] = (((r << 2) | (r >> 1)) << 11) | (((g << 3) | g) << 5) | ((b << 3) | (b << 1) | (b >> 1));
+    }
+    return lut;
+}
+
+// Not const, so that it is in RAM
+static std::array<uint16_t, 256> rgb332_to_rgb565 = make_rgb332_to_rgb565();
+
+// Write w pixels converted from 8-bit src through lut, a pair at a time where possible
+static void blit_convert_row(uint16_t* dst, const uint8_t* src, uint w, const uint16_t* lut, int32_t colour_key)
+{
+    if (colour_key >= 0) {
+        for (uint i = 0; i < w; ++i) {
+            if (src[i] != colour_key) dst[i] = lut[src[i]];
+        }
+        return;
+    }
+
+    if (w && ((uintptr_t)dst & 2)) {
+        *dst++ = lut[*src++];
+        --w;
+    }
+
+    uint32_t* pair_dst = (uint32_t*)dst;
+    for (; w >= 2; w -= 2, src += 2) {
+        *pair_dst++ = lut[src[0]] | ((uint32_t)lut[src[1]] << 16);
+    }
+
+    if (w) *(uint16_t*)pair_dst = lut[*src];
+}
+
+void DVHSTX::blit(const void* src, uint src_stride, BlitFormat format, const Rect &dest, const Rect &clip,
+                  int32_t colour_key, const uint16_t* src_palette)
+{
+    // The source format must match the frame's pixels
+    if (format == BLIT_P8) {
+        if (mode != MODE_PALETTE && mode != MODE_PALETTE_RGB565) return;
+    }
+    else if (mode != MODE_RGB565) return;
+    if (format == BLIT_P8_TO_RGB565 && !src_palette) return;
+
+    const Rect r = dest.intersection(clip).intersection(Rect(0, 0, frame_width, frame_height));
+    if (r.empty()) return;
+
+    const uint w = r.w;
+    const uint src_offset = (r.y - dest.y) * src_stride + (r.x - dest.x);
+
+    if (format == BLIT_RGB565) {
+        const uint16_t* src_ptr = (const uint16_t*)src + src_offset;
+        for (int y = r.y; y < r.y + r.h; ++y, src_ptr += src_stride) {
+            uint16_t* dst = point_to_ptr16(Point(r.x, y));
+            if (colour_key < 0) {
+                memcpy(dst, src_ptr, w * 2);
+            }
+            else {
+                for (uint i = 0; i < w; ++i) {
+                    if (src_ptr[i] != colour_key) dst[i] = src_ptr[i];
+                }
+            }
+        }
+    }
+    else if (format == BLIT_P8) {
+        const uint8_t* src_ptr = (const uint8_t*)src + src_offset;
+        for (int y = r.y; y < r.y + r.h; ++y, src_ptr += src_stride) {
+            uint8_t* dst = point_to_ptr_palette(Point(r.x, y));
+            if (colour_key < 0) {
+                memcpy(dst, src_ptr, w);
+            }
+            else {
+                for (uint i = 0; i < w; ++i) {
+                    if (src_ptr[i] != colour_key) dst[i] = src_ptr[i];
+                }
+            }
+        }
+    }
+    else {
+        const uint16_t* lut = (format == BLIT_RGB332_TO_RGB565) ? rgb332_to_rgb565.data() : src_palette;
+        if (!lut) return;
+
+        const uint8_t* src_ptr = (const uint8_t*)src + src_offset;
+        for (int y = r.y; y < r.y + r.h; ++y, src_ptr += src_stride) {
+            blit_convert_row(point_to_ptr16(Point(r.x, y)), src_ptr, w, lut, colour_key);
+        }
+    }
+}
+
+void DVHSTX::clear_display_list()
+{
+    while (display_list_flip_next) __wfe();
+    display_list_back_len = 0;
+}
+
+bool DVHSTX::add_display_list_entry(const DisplayListEntry& entry)
+{
+    if (!display_list_buffers) {
+        display_list_buffers = (DisplayListEntry*)malloc(2 * DISPLAY_LIST_SIZE * sizeof(DisplayListEntry));
+        if (!display_list_buffers) return false;
+        display_list = display_list_buffers;
+        display_list_back = display_list_buffers + DISPLAY_LIST_SIZE;
+    }
+
+    while (display_list_flip_next) __wfe();
+    if (display_list_back_len == DISPLAY_LIST_SIZE) return false;
+
+    // Keep the list sorted by line, entries for the same line apply in the order added
+    int i = display_list_back_len;
+    while (i > 0 && display_list_back[i - 1].line > entry.line) {
+        display_list_back[i] = display_list_back[i - 1];
+        --i;
+    }
+    display_list_back[i] = entry;
+    ++display_list_back_len;
+    return true;
+}
+
+bool DVHSTX::add_display_list_palette(uint16_t line, uint8_t entry, RGB888 colour)
+{
+    return add_display_list_entry({line, DISPLAY_LIST_PALETTE, entry, display_palette_entry(colour)});
+}
+
+bool DVHSTX::add_display_list_scroll(uint16_t line, uint16_t offset)
+{
+    return add_display_list_entry({line, DISPLAY_LIST_SCROLL, 0, offset});
+}
+
+void DVHSTX::flip_display_list()
+{
+    if (!display_list_buffers) return;
+    display_list_flip_next = true;
+}
+
+void DVHSTX::set_tileset(const uint8_t* tiles, uint8_t tile_size, uint tile_count)
+{
+    tile_shift = (tile_size == 16) ? 4 : 3;
+    this->tile_count = std::min(tile_count, 256u);
+    tileset = tiles;
+}
+
+void DVHSTX::write_tile(const Point &p, uint8_t tile)
+{
+    if (tile >= tile_count) return;
+    *point_to_ptr_tile(p) = tile;
+}
+
+void DVHSTX::write_tile_span(const Point &p, uint l, uint8_t* tiles)
+{
+    uint8_t* ptr = point_to_ptr_tile(p);
+    if (tile_count == 256) {
+        memcpy(ptr, tiles, l);
+        return;
+    }
+
+    for (uint i = 0; i < l; ++i) {
+        if (tiles[i] < tile_count) ptr[i] = tiles[i];
+    }
+}
+
 void DVHSTX::write_text(const Point &p, const char* text, TextColour colour, bool immediate)
+{
+    write_text(p, text, colour, TEXT_BLACK, 0, immediate);
+}
+
+void DVHSTX::write_text(const Point &p, const char* text, TextColour colour, TextColour background, uint8_t attributes, bool immediate)
 {
     char* ptr = (char*)point_to_ptr_text(p, immediate);
     int len = std::min((int)(frame_width - p.x), (int)strlen(text));
     memcpy(ptr, text, len);
-    if (mode == MODE_TEXT_RGB111) memset(ptr + frame_width * frame_height, (uint8_t)colour, len);
+    if (mode == MODE_TEXT_RGB111) {
+        memset(ptr + frame_width * frame_height, (uint8_t)colour, len);
+        memset(ptr + 2 * frame_width * frame_height, (uint8_t)background | attributes, len);
+    }
+    if (!immediate) mark_text_dirty((uint8_t*)ptr - frame_buffer_back, len);
+}
+
+void DVHSTX::scroll_text(int n, bool immediate)
+{
+    int& origin = immediate ? text_row_origin_display : text_row_origin_back;
+    const int rows = std::min(abs(n), (int)frame_height);
+
+    origin += n % frame_height;
+    if (origin < 0) origin += frame_height;
+    else if (origin >= frame_height) origin -= frame_height;
+
+    // Clear the rows scrolled in
+    const int first_row = (n > 0) ? frame_height - rows : 0;
+    for (int y = first_row; y < first_row + rows; ++y) {
+        clear_text_row(y, TEXT_BLACK, immediate);
+    }
+}
+
+void DVHSTX::scroll_text(int n, int top, int bottom, TextColour background, bool immediate)
+{
+    top = std::max(top, 0);
+    bottom = std::min(bottom, frame_height - 1);
+    if (top > bottom) return;
+
+    // Scrolling the whole grid only needs the row origin to move
+    if (top == 0 && bottom == frame_height - 1 && background == TEXT_BLACK) {
+        scroll_text(n, immediate);
+        return;
+    }
+
+    const int rows = std::min(abs(n), bottom - top + 1);
+    if (n > 0) {
+        for (int y = top; y <= bottom - rows; ++y) copy_text_row(y, y + rows, immediate);
+        for (int y = bottom - rows + 1; y <= bottom; ++y) clear_text_row(y, background, immediate);
+    }
+    else {
+        for (int y = bottom; y >= top + rows; --y) copy_text_row(y, y - rows, immediate);
+        for (int y = top; y < top + rows; ++y) clear_text_row(y, background, immediate);
+    }
+}
+
+void DVHSTX::copy_text_row(int dst_y, int src_y, bool immediate)
+{
+    uint8_t* dst_ptr = point_to_ptr_text({0, dst_y}, immediate);
+    const uint8_t* src_ptr = point_to_ptr_text({0, src_y}, immediate);
+    for (int i = 0; i < frame_bytes_per_pixel; ++i) {
+        memcpy(dst_ptr + i * frame_width * frame_height, src_ptr + i * frame_width * frame_height, frame_width);
+    }
+    if (!immediate) mark_text_dirty(dst_ptr - frame_buffer_back, frame_width);
+}
+
+// Clear a row in every plane, with the given background in RGB111
+void DVHSTX::clear_text_row(int y, TextColour background, bool immediate)
+{
+    uint8_t* ptr = point_to_ptr_text({0, y}, immediate);
+    for (int i = 0; i < frame_bytes_per_pixel; ++i) {
+        memset(ptr + i * frame_width * frame_height, (i == 2) ? (uint8_t)background : 0, frame_width);
+    }
+    if (!immediate) mark_text_dirty(ptr - frame_buffer_back, frame_width);
+}
+
+void DVHSTX::set_text_fine_scroll(int x, int y)
+{
+    x = std::max(0, std::min(x, text_cell_width - 1));
+    y = std::max(0, std::min(y, text_cell_height - 1));
+
+    // Pixels of a cell that remain in the cell after moving x pixels left
+    uint32_t mask = 0;
+    for (int i = 0; i < text_cell_width - x; ++i) mask |= pack_char_pixel(i, 3);
+
+    // The vsync handler reads all three, so don't let it see a partial update
+    const uint32_t irq_state = save_and_disable_interrupts();
+    text_fine_x_mask_next = mask;
+    text_fine_x_next = x;
+    text_fine_y_next = y;
+    restore_interrupts(irq_state);
+}
+
+void DVHSTX::set_cursor(const Point &p)
+{
+    // The cursor is drawn from the scanline handler, which must not see a new x with the old y
+    const uint32_t irq_state = save_and_disable_interrupts();
+    cursor_x = p.x;
+    cursor_y = p.y;
+    restore_interrupts(irq_state);
+}
+
+void DVHSTX::set_cursor_shape(TextCursor shape, uint8_t blink_frames)
+{
+    cursor_visible = false;
+    cursor_shape = shape;
+    cursor_blink_frames = blink_frames;
+    cursor_blink_count = 0;
+    update_cursor();
+}
+
+void DVHSTX::update_cursor()
+{
+    // Underline cursors are an eighth of the cell high, and bar cursors a
+    // seventh of the cell wide, which is 3 rows and 2 columns for 14 x 24 cells
+    const int underline_rows = std::max(1, text_cell_height / 8);
+    const int bar_columns = std::max(1, text_cell_width / 7);
+
+    cursor_first_row = (cursor_shape == CURSOR_UNDERLINE) ? text_cell_height - underline_rows : 0;
+    cursor_last_row = text_cell_height - 1;
+    cursor_columns = (cursor_shape == CURSOR_BAR) ? bar_columns : text_cell_width;
+
+    cursor_mono_bits = 0;
+    for (int x = 0; x < cursor_columns; ++x) cursor_mono_bits |= pack_char_pixel(x, 3);
+
+    cursor_visible = (cursor_shape != CURSOR_NONE);
+}
+
+void DVHSTX::write_text_colour(const Point &p, uint l, TextColour colour, TextColour background, uint8_t attributes, bool immediate)
+{
+    if (mode != MODE_TEXT_RGB111) return;
+
+    uint8_t* ptr = point_to_ptr_text(p, immediate);
+    int len = std::min((int)(frame_width - p.x), (int)l);
+    memset(ptr + frame_width * frame_height, (uint8_t)colour, len);
+    memset(ptr + 2 * frame_width * frame_height, (uint8_t)background | attributes, len);
+    if (!immediate) mark_text_dirty(ptr - frame_buffer_back, len);
+}
+
+void DVHSTX::mark_text_dirty(uint32_t cell, int len)
+{
+    if (!text_dirty || len <= 0) return;
+
+    // Set the bits for the range a word at a time
+    const uint32_t end = cell + len;
+    while (cell < end) {
+        const uint32_t bit = cell & 31;
+        const uint32_t n = std::min(32 - bit, end - cell);
+        text_dirty[cell >> 5] |= (n == 32) ? 0xFFFFFFFF : ((1u << n) - 1) << bit;
+        cell += n;
+    }
+}
+
+void DVHSTX::update_text_async()
+{
+    wait_for_dma();
+    if (text_dirty) text_update_next = true;
+}
+
+void DVHSTX::update_text()
+{
+    update_text_async();
+    wait_for_flip();
+}
+
+bool DVHSTX::enable_text_overlay()
+{
+    if (mode == MODE_TEXT_MONO || mode == MODE_TEXT_RGB111 || mode == MODE_RGB888) return false;
+    if (text_cell_width < 4 || text_cell_width > 16 || text_cell_height < 1) return false;
+    if (overlay_enabled) return true;
+
+    if (!font_cache && !build_font_cache()) return false;
+    if (line_buffer_count < NUM_CHANS && !add_overlay_line_buffer()) return false;
+
+    if (!overlay_chars) {
+        overlay_width = timing_mode->h_active_pixels / text_cell_width;
+        overlay_height = timing_mode->v_active_lines / text_cell_height;
+        overlay_chars = (uint8_t*)malloc(overlay_width * overlay_height * 2 + overlay_height);
+        if (!overlay_chars) return false;
+        overlay_colours = overlay_chars + overlay_width * overlay_height;
+        overlay_row_used = overlay_colours + overlay_width * overlay_height;
+        clear_overlay();
+    }
+
+    overlay_enabled = true;
+    return true;
+}
+
+// The overlay fills every scanline separately, so needs a line buffer per
+// channel even with vertical repeat.  The larger buffer is swapped in during
+// vertical blanking, once the channels are only sending blank lines.
+bool DVHSTX::add_overlay_line_buffer()
+{
+    uint32_t* new_line_buffers = (uint32_t*)malloc(line_buffer_words * 4 * NUM_CHANS);
+    if (!new_line_buffers) return false;
+
+    for (int i = 0; i < NUM_CHANS; ++i) {
+        memcpy(&new_line_buffers[i * line_buffer_words], vactive_line_header, count_of(vactive_line_header) * sizeof(uint32_t));
+    }
+
+    uint32_t* old_line_buffers;
+    while (true) {
+        while (v_scanline < NUM_CHANS || v_scanline >= v_inactive_total - 1) tight_loop_contents();
+
+        const uint32_t irq_state = save_and_disable_interrupts();
+        if (v_scanline >= NUM_CHANS && v_scanline < v_inactive_total - 1) {
+            old_line_buffers = line_buffers;
+            line_buffers = new_line_buffers;
+            line_num = -1;
+            restore_interrupts(irq_state);
+            break;
+        }
+        restore_interrupts(irq_state);
+    }
+
+    free(old_line_buffers);
+    line_buffer_count = NUM_CHANS;
+    return true;
+}
+
+void DVHSTX::disable_text_overlay()
+{
+    overlay_enabled = false;
+}
+
+void DVHSTX::write_overlay_text(const Point &p, const char* text, TextColour colour)
+{
+    if (!overlay_chars || p.x < 0 || p.y < 0 || p.x >= overlay_width || p.y >= overlay_height) return;
+
+    const int offset = p.y * overlay_width + p.x;
+    int len = std::min((int)(overlay_width - p.x), (int)strlen(text));
+    memcpy(overlay_chars + offset, text, len);
+    memset(overlay_colours + offset, (uint8_t)colour, len);
+    overlay_row_used[p.y] = 1;
+}
+
+void DVHSTX::clear_overlay()
+{
+    if (!overlay_chars) return;
+
+    memset(overlay_chars, ' ', overlay_width * overlay_height);
+    memset(overlay_colours, 0, overlay_width * overlay_height);
+    memset(overlay_row_used, 0, overlay_height);
 }
 
 void DVHSTX::clear()
 {
     memset(frame_buffer_back, 0, frame_width * frame_height * frame_bytes_per_pixel);
+    text_row_origin_back = 0;
+    mark_text_dirty(0, frame_width * frame_height);
 }
 
 DVHSTX::DVHSTX()
@@ -628,23 +2132,63 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
     v_scanline = 2;
     flip_next = false;
 
+    display_list_len = 0;
+    display_list_back_len = 0;
+    display_list_pos = 0;
+    display_list_flip_next = false;
+    scroll_offset = 0;
+    text_row_origin_display = 0;
+    text_row_origin_back = 0;
+    text_fine_x = text_fine_x_next = 0;
+    text_fine_y = text_fine_y_next = 0;
+
     display_width = width;
     display_height = height;
     frame_width = width;
     frame_height = height;
     mode = mode_;
 
+    const TextFont& font = text_font ? *text_font : default_text_font;
+    text_cell_width = font.cell_width;
+    text_cell_height = font.cell_height;
+    text_underline_row = text_cell_height - 1 - text_cell_height / 8;
+    update_cursor();
+    if (text_charset == CHARSET_ASCII) {
+        text_first_glyph = FIRST_GLYPH;
+        text_glyph_count = GLYPH_COUNT;
+    }
+    else {
+        text_first_glyph = FIRST_GLYPH_8BIT;
+        text_glyph_count = GLYPH_COUNT_8BIT;
+    }
+
     timing_mode = nullptr;
     if (mode == MODE_TEXT_MONO || mode == MODE_TEXT_RGB111) {
-        width = 1280;
-        height = 720;
-        display_width = 91;
-        frame_width = 91;
-        display_height = 30;
-        frame_height = 30;
+        if (text_cell_width < 4 || text_cell_width > 16 || text_cell_height < 1) {
+            dvhstx_debug("Unsupported text cell size %dx%d", text_cell_width, text_cell_height);
+            return false;
+        }
+
+        // Find a resolution that fits the requested character grid to within one cell
+        for (auto text_timing : text_timings) {
+            const int h_spare = text_timing->h_active_pixels - width * text_cell_width;
+            const int v_spare = text_timing->v_active_lines - height * text_cell_height;
+            if (h_spare >= 0 && h_spare < text_cell_width && v_spare >= 0 && v_spare < text_cell_height) {
+                timing_mode = text_timing;
+                break;
+            }
+        }
+        if (!timing_mode) {
+            dvhstx_debug("No resolution fits a %dx%d character grid", width, height);
+            return false;
+        }
+
+        display_width = width;
+        frame_width = width;
+        display_height = height;
+        frame_height = height;
         h_repeat_shift = 0;
         v_repeat_shift = 0;
-        timing_mode = &dvi_timing_1280x720p_rb_50hz;
     }
     else if (width == 320 && height == 180) {
         h_repeat_shift = 2;
@@ -704,8 +2248,21 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
         return false;
     }
 
+    is_tilemap = (mode == MODE_TILEMAP_PALETTE || mode == MODE_TILEMAP_RGB565);
+    tileset = nullptr;
+    tile_shift = 3;
+    tile_count = 0;
+    if (is_tilemap) {
+        // The frame buffers hold the tile map, sized for the smallest tiles
+        frame_width = (display_width + 7) >> 3;
+        frame_height = (display_height + 7) >> 3;
+    }
+
     display = this;
-    display_palette = get_palette();
+    display_palette = display_palettes[0];
+    display_palette_back = display_palettes[1];
+    palette_dirty = false;
+    palette_flip_next = false;
     
     dvhstx_debug("Setup clock\n");
     display_setup_clock();
@@ -736,11 +2293,16 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
     vactive_line_header[4] |= timing_mode->h_back_porch;
     vactive_line_header[6] |= timing_mode->h_active_pixels;
 
-    memcpy(vactive_text_line_header, vactive_text_line_header_src, sizeof(vactive_text_line_header_src));
-    vactive_text_line_header[0] |= timing_mode->h_front_porch;
-    vactive_text_line_header[2] |= timing_mode->h_sync_width;
-    vactive_text_line_header[4] |= timing_mode->h_back_porch;
-    vactive_text_line_header[7+6] |= timing_mode->h_active_pixels - 6;
+    memcpy(vactive_text_line_header, vactive_line_header, (count_of(vactive_line_header) - 1) * sizeof(uint32_t));
+    vactive_text_line_header_len = count_of(vactive_line_header) - 1;
+    const int text_line_padding = timing_mode->h_active_pixels - frame_width * text_cell_width;
+    if (text_line_padding > 0 && text_line_padding <= MAX_TEXT_LINE_PADDING) {
+        vactive_text_line_header[vactive_text_line_header_len++] = HSTX_CMD_RAW | text_line_padding;
+        for (int i = 0; i < text_line_padding; ++i) {
+            vactive_text_line_header[vactive_text_line_header_len++] = (i & 1) ? BLACK_PIXEL_B : BLACK_PIXEL_A;
+        }
+    }
+    vactive_text_line_header[vactive_text_line_header_len++] = HSTX_CMD_TMDS | (timing_mode->h_active_pixels - text_line_padding);
 
     switch (mode) {
     case MODE_RGB565:
@@ -751,6 +2313,10 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
         frame_bytes_per_pixel = 1;
         line_bytes_per_pixel = 4;
         break;
+    case MODE_PALETTE_RGB565:
+        frame_bytes_per_pixel = 1;
+        line_bytes_per_pixel = 2;
+        break;
     case MODE_RGB888:
         frame_bytes_per_pixel = 4;
         line_bytes_per_pixel = 4;
@@ -760,8 +2326,17 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
         line_bytes_per_pixel = 4;
         break;
     case MODE_TEXT_RGB111:
-        frame_bytes_per_pixel = 2;
-        line_bytes_per_pixel = 14;
+        // Characters, colours and background attributes
+        frame_bytes_per_pixel = 3;
+        line_bytes_per_pixel = text_cell_width;
+        break;
+    case MODE_TILEMAP_PALETTE:
+        frame_bytes_per_pixel = 1;
+        line_bytes_per_pixel = 4;
+        break;
+    case MODE_TILEMAP_RGB565:
+        frame_bytes_per_pixel = 1;
+        line_bytes_per_pixel = 2;
         break;
     default:
         dvhstx_debug("Unsupported mode %d", (int)mode);
@@ -783,30 +2358,38 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
     memset(frame_buffer_back, 0, frame_width * frame_height * frame_bytes_per_pixel);
 
     memset(palette, 0, PALETTE_SIZE * sizeof(palette[0]));
+    memset(display_palettes, 0, sizeof(display_palettes));
 
     frame_buffer_display = frame_buffer_display;
     dvhstx_debug("Frame buffers inited\n");
 
     const bool is_text_mode = (mode == MODE_TEXT_MONO || mode == MODE_TEXT_RGB111);
-    const int frame_pixel_words = (frame_width * h_repeat * line_bytes_per_pixel + 3) >> 2;
-    const int frame_line_words = frame_pixel_words + (is_text_mode ? count_of(vactive_text_line_header) : count_of(vactive_line_header));
+    const int frame_pixel_words = ((is_tilemap ? display_width : frame_width) * h_repeat * line_bytes_per_pixel + 3) >> 2;
+    const int frame_line_words = frame_pixel_words + (is_text_mode ? vactive_text_line_header_len : count_of(vactive_line_header));
+    // A line buffer per channel is needed whenever each scanline is filled separately,
+    // which is the case without vertical repeat.  The text overlay also needs them,
+    // and adds the third buffer when it is first enabled.
     const int frame_lines = (v_repeat == 1) ? NUM_CHANS : NUM_FRAME_LINES;
     line_buffers = (uint32_t*)malloc(frame_line_words * 4 * frame_lines);
+    line_buffer_words = frame_line_words;
+    line_buffer_count = frame_lines;
 
     for (int i = 0; i < frame_lines; ++i)
     {
-        if (is_text_mode) memcpy(&line_buffers[i * frame_line_words], vactive_text_line_header, count_of(vactive_text_line_header) * sizeof(uint32_t));
+        if (is_text_mode) memcpy(&line_buffers[i * frame_line_words], vactive_text_line_header, vactive_text_line_header_len * sizeof(uint32_t));
         else memcpy(&line_buffers[i * frame_line_words], vactive_line_header, count_of(vactive_line_header) * sizeof(uint32_t));
     }
 
-    if (mode == MODE_TEXT_RGB111) {
-        // Need to pre-render the font to RAM to be fast enough.
-        font_cache = (uint32_t*)malloc(4 * FONT->line_height * GLYPH_COUNT);
-        uint32_t* font_cache_ptr = font_cache;
-        for (int c = 0; c < GLYPH_COUNT; ++c) {
-            for (int y = 0; y < FONT->line_height; ++y) {
-                *font_cache_ptr++ = render_char_line(c + FIRST_GLYPH, y);
-            }
+    if (is_text_mode) {
+        if (!build_font_cache()) {
+            dvhstx_debug("Failed to allocate font cache\n");
+            return false;
+        }
+
+        text_dirty = (uint32_t*)calloc((frame_width * frame_height + 31) >> 5, sizeof(uint32_t));
+        if (!text_dirty) {
+            dvhstx_debug("Failed to allocate text dirty map\n");
+            return false;
         }
     }
 
@@ -818,6 +2401,8 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
 
     switch (mode) {
     case MODE_RGB565:
+    case MODE_PALETTE_RGB565:
+    case MODE_TILEMAP_RGB565:
         // Configure HSTX's TMDS encoder for RGB565
         hstx_ctrl_hw->expand_tmds =
             4  << HSTX_CTRL_EXPAND_TMDS_L2_NBITS_LSB |
@@ -837,6 +2422,7 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
         break;
 
     case MODE_PALETTE:
+    case MODE_TILEMAP_PALETTE:
         // Configure HSTX's TMDS encoder for RGB888
         hstx_ctrl_hw->expand_tmds =
             7  << HSTX_CTRL_EXPAND_TMDS_L2_NBITS_LSB |
@@ -865,10 +2451,10 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
             1  << HSTX_CTRL_EXPAND_TMDS_L0_NBITS_LSB |
             18  << HSTX_CTRL_EXPAND_TMDS_L0_ROT_LSB;
 
-        // Pixels and control symbols (RAW) are an
-        // entire 32-bit word.
+        // Each character cell is an entire 32-bit word, as are
+        // control symbols (RAW).
         hstx_ctrl_hw->expand_shift =
-            14 << HSTX_CTRL_EXPAND_SHIFT_ENC_N_SHIFTS_LSB |
+            text_cell_width << HSTX_CTRL_EXPAND_SHIFT_ENC_N_SHIFTS_LSB |
             30 << HSTX_CTRL_EXPAND_SHIFT_ENC_SHIFT_LSB |
             1 << HSTX_CTRL_EXPAND_SHIFT_RAW_N_SHIFTS_LSB |
             0 << HSTX_CTRL_EXPAND_SHIFT_RAW_SHIFT_LSB;
@@ -947,10 +2533,12 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
     // reconfigure the one that just finished, meanwhile the other channel(s)
     // are already making progress.
     // Using just 2 channels was insufficient to avoid issues with the IRQ.
+    // They are high priority so background fills and copies can't starve them.
     dma_channel_config c;
     c = dma_channel_get_default_config(0);
     channel_config_set_chain_to(&c, 1);
     channel_config_set_dreq(&c, DREQ_HSTX);
+    channel_config_set_high_priority(&c, true);
     dma_channel_configure(
         0,
         &c,
@@ -962,6 +2550,7 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
     c = dma_channel_get_default_config(1);
     channel_config_set_chain_to(&c, 2);
     channel_config_set_dreq(&c, DREQ_HSTX);
+    channel_config_set_high_priority(&c, true);
     dma_channel_configure(
         1,
         &c,
@@ -974,6 +2563,7 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
         c = dma_channel_get_default_config(i);
         channel_config_set_chain_to(&c, (i+1) % NUM_CHANS);
         channel_config_set_dreq(&c, DREQ_HSTX);
+        channel_config_set_high_priority(&c, true);
         dma_channel_configure(
             i,
             &c,
@@ -995,6 +2585,16 @@ bool DVHSTX::init(uint16_t width, uint16_t height, Mode mode_, Pinout pinout)
 
     dma_channel_start(0);
 
+    // Spare channel for background fills and copies, at a lower priority
+    // than the scanline channels.
+    dma_op_channel = dma_claim_unused_channel(false);
+    if (dma_op_channel >= 0) {
+        dma_irqn_acknowledge_channel(1, dma_op_channel);
+        dma_irqn_set_channel_enabled(1, dma_op_channel, true);
+        irq_add_shared_handler(DMA_IRQ_1, dma_op_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+    }
+
     dvhstx_debug("DVHSTX started\n");
 
     for (int i = 0; i < frame_height; ++i) {
@@ -1019,10 +2619,42 @@ void DVHSTX::reset() {
     for (int i = 0; i < NUM_CHANS; ++i)
         dma_channel_abort(i);
 
+    if (dma_op_channel >= 0) {
+        dma_irqn_set_channel_enabled(1, dma_op_channel, false);
+        irq_remove_handler(DMA_IRQ_1, dma_op_irq_handler);
+        dma_channel_abort(dma_op_channel);
+        dma_irqn_acknowledge_channel(1, dma_op_channel);
+        dma_channel_unclaim(dma_op_channel);
+        dma_op_channel = -1;
+    }
+    dma_op_done = dma_op_started;
+
     if (font_cache) {
         free(font_cache);
         font_cache = nullptr;
     }
+    if (text_dirty) {
+        free(text_dirty);
+        text_dirty = nullptr;
+    }
+    text_update_next = false;
+    text_update_word = 0;
+    if (overlay_chars) {
+        free(overlay_chars);
+        overlay_chars = nullptr;
+        overlay_colours = nullptr;
+        overlay_row_used = nullptr;
+    }
+    overlay_width = 0;
+    overlay_height = 0;
+    overlay_enabled = false;
+    overlay_active = false;
+    if (display_list_buffers) {
+        free(display_list_buffers);
+        display_list_buffers = nullptr;
+        display_list = nullptr;
+        display_list_back = nullptr;
+    }
     free(line_buffers);
 
 #ifndef MICROPY_BUILD_TYPE
@@ -1037,7 +2669,14 @@ void DVHSTX::flip_blocking() {
 }
 
 void DVHSTX::flip_now() {
+    wait_for_dma();
     std::swap(frame_buffer_display, frame_buffer_back);
+    std::swap(text_row_origin_display, text_row_origin_back);
+    if (palette_dirty) {
+        prepare_palette();
+        std::swap(display_palette, display_palette_back);
+        carry_display_list_palette();
+    }
 }
 
 void DVHSTX::wait_for_vsync() {
@@ -1045,9 +2684,11 @@ void DVHSTX::wait_for_vsync() {
 }
 
 void DVHSTX::flip_async() {
+    wait_for_dma();
+    if (palette_dirty) flip_palette();
     flip_next = true;
 }
 
 void DVHSTX::wait_for_flip() {
-    while (flip_next) __wfe();
+    while (flip_next || palette_flip_next || text_update_next) __wfe();
 }
\ No newline at end of file
@@ -28,6 +28,7 @@ namespace pimoroni {
   class DVHSTX {
   public:
     static constexpr int PALETTE_SIZE = 256;
+    static constexpr int DISPLAY_LIST_SIZE = 256;
 
     struct Pinout {
         uint8_t clk_p, rgb_p[3];
@@ -39,6 +40,9 @@ namespace pimoroni {
       MODE_RGB888 = 3,
       MODE_TEXT_MONO = 4,
       MODE_TEXT_RGB111 = 5,
+      MODE_TILEMAP_PALETTE = 6,
+      MODE_TILEMAP_RGB565 = 7,
+      MODE_PALETTE_RGB565 = 8,  // As MODE_PALETTE, but output as RGB565 using half the bandwidth
     };
 
     enum TextColour {
@@ -52,6 +56,61 @@ namespace pimoroni {
       TEXT_WHITE   = 0b1001001,
     };    
 
+    // Text cell attributes, combined with a background TextColour
+    enum TextAttribute {
+      TEXT_INVERSE   = 0b00000010,
+      TEXT_UNDERLINE = 0b00000100,
+      TEXT_BLINK     = 0b00010000,
+    };
+
+    enum TextCursor {
+      CURSOR_NONE = 0,
+      CURSOR_BLOCK = 1,
+      CURSOR_UNDERLINE = 2,
+      CURSOR_BAR = 3,
+    };
+
+    // Character set for the text modes and text overlay.  CP437 and Latin-1
+    // use all 8 bit codes, 1 to 255.
+    enum TextCharset {
+      CHARSET_ASCII = 0,
+      CHARSET_CP437 = 1,
+      CHARSET_LATIN1 = 2,
+    };
+
+    // Font for the text modes and text overlay.  Characters are drawn in
+    // cell_width x cell_height pixel cells, cell_width may be 4 to 16.
+    // If bitmap is set it holds glyph_count 1bpp glyphs starting from
+    // first_char, each glyph row (cell_width + 7) / 8 bytes, most significant
+    // bit first.  Otherwise the built in font is scaled to fit the cell.
+    struct TextFont {
+      uint8_t cell_width;
+      uint8_t cell_height;
+      const uint8_t* bitmap;
+      uint8_t first_char;
+      uint16_t glyph_count;
+    };
+
+    // Source pixel formats for blit
+    enum BlitFormat {
+      BLIT_RGB565 = 0,            // RGB565 source to an RGB565 frame
+      BLIT_P8 = 1,                // Palette index source to a palette frame
+      BLIT_P8_TO_RGB565 = 2,      // Palette index source, converted through a source palette
+      BLIT_RGB332_TO_RGB565 = 3,  // RGB332 source to an RGB565 frame
+    };
+
+    enum DisplayListAction {
+      DISPLAY_LIST_PALETTE = 0,
+      DISPLAY_LIST_SCROLL = 1,
+    };
+
+    struct DisplayListEntry {
+      uint16_t line;
+      uint8_t action;
+      uint8_t index;
+      uint32_t value;
+    };
+
     //--------------------------------------------------
     // Variables
     //--------------------------------------------------
@@ -80,20 +139,162 @@ namespace pimoroni {
       void write_pixel_span(const Point &p, uint l, uint16_t *data);
       void read_pixel_span(const Point &p, uint l, uint16_t *data);
 
+      // Blend colour over l pixels with alpha from 0 (unchanged) to 255 (colour),
+      // either for the whole span or per pixel.
+      void blend_pixel_span(const Point &p, uint l, uint16_t colour, uint8_t alpha);
+      void blend_pixel_span(const Point &p, uint l, uint16_t colour, const uint8_t* alpha);
+
       // 256 colour palette mode.
+      // The palette is double buffered: changes are made to the back palette and
+      // shown from the next vsync after flip_palette().  Flipping the frame buffers
+      // also flips the palette if it has been changed.  Entries set by the
+      // display list are kept in the new palette until the list next sets them.
       void set_palette(RGB888 new_palette[PALETTE_SIZE]);
       void set_palette_colour(uint8_t entry, RGB888 colour);
       RGB888* get_palette();
 
+      // Incremented whenever the palette is changed through the methods above,
+      // so users can tell when colours they derived from it are out of date.
+      // Changes written through get_palette() directly are not counted.
+      uint32_t get_palette_generation() const { return palette_generation; }
+
+      // Rotate count entries starting at first by n places towards higher entries
+      void rotate_palette(uint8_t first, uint count, int n);
+
+      void flip_palette();
+
       void write_palette_pixel(const Point &p, uint8_t colour);
       void write_palette_pixel_span(const Point &p, uint l, uint8_t colour);
       void write_palette_pixel_span(const Point &p, uint l, uint8_t* data);
       void read_palette_pixel_span(const Point &p, uint l, uint8_t *data);
 
-      // Text mode (91 x 30)
+      // Copy a rectangle of pixels to dest, clipped to clip and the frame.
+      // src is the pixel drawn at the top left of dest, rows are src_stride pixels
+      // apart.  Source pixels equal to colour_key are not drawn, unless it is negative.
+      // src_palette gives the RGB565 colour of each index for BLIT_P8_TO_RGB565.
+      // Nothing is drawn if the format doesn't match the mode: BLIT_P8 needs a
+      // palette mode and the other formats MODE_RGB565.
+      void blit(const void* src, uint src_stride, BlitFormat format, const Rect &dest, const Rect &clip,
+                int32_t colour_key = -1, const uint16_t* src_palette = nullptr);
+
+      // Background fills and copies of the back buffer on a spare DMA channel.
+      // Each waits for any earlier operation, starts and returns a handle for
+      // is_dma_done() and wait_for_dma().  Flips wait for running operations.
+      // If no DMA channel was free the operations run before returning.
+      // The fill colour is an RGB565 colour or a palette index, by mode.
+      uint32_t clear_async();
+      uint32_t fill_rect_async(const Rect &r, uint16_t colour);
+      uint32_t copy_rect_async(const Rect &r, const void* src, uint src_stride);
+      uint32_t copy_async(void* dst, const void* src, uint32_t len);
+      bool is_dma_done(uint32_t handle) const { return (int32_t)(dma_op_done - handle) >= 0; }
+      void wait_for_dma(uint32_t handle);
+      void wait_for_dma() { wait_for_dma(dma_op_started); }
+
+      // Display list for pixel and tile map modes.  Each entry is applied as the
+      // display reaches the given frame buffer line: setting a palette entry
+      // (palette modes) or the vertical scroll offset.  The scroll offset is reset
+      // to zero at the top of each frame, palette changes persist into the next
+      // frame so lists changing the palette should also set it at line 0.
+      // Entries are added to the back list, flip_display_list() swaps it in at
+      // the next vsync and leaves an empty back list.  The front list is applied
+      // every frame until the next flip.
+      void clear_display_list();
+      bool add_display_list_palette(uint16_t line, uint8_t entry, RGB888 colour);
+      bool add_display_list_scroll(uint16_t line, uint16_t offset);
+      void flip_display_list();
+
+      // Tile map modes.  The frame buffers hold one tile index per 8x8 tile
+      // instead of pixels, and the tiles are expanded as each scanline is displayed.
+      // The tileset is tile_size x tile_size pixels per tile, stored consecutively,
+      // with pixels as palette indices or RGB565 depending on the mode.
+      // tile_size may be 8 or 16, with 16x16 tiles only the top left of the map is used.
+      // The tileset is read during scanout so should be in RAM, not flash.
+      // tile_count is the number of tiles in the tileset, tiles past the end
+      // are not written to the map.  The pixel drawing methods do nothing in
+      // tile map modes.
+      void set_tileset(const uint8_t* tiles, uint8_t tile_size = 8, uint tile_count = 256);
+      void write_tile(const Point &p, uint8_t tile);
+      void write_tile_span(const Point &p, uint l, uint8_t* tiles);
+
+      // Size of the tile map in 8x8 tiles, and the number of tiles in the tileset
+      int get_tilemap_width() const { return frame_width; }
+      int get_tilemap_height() const { return frame_height; }
+      uint get_tile_count() const { return tile_count; }
+
+      // Text overlay for pixel and tile map modes.  A grid of character cells
+      // of the text font, in output pixels, is drawn over the frame as each
+      // scanline is displayed.  Spaces and the background of each cell are
+      // transparent.  Overlay writes are shown immediately, not on flip.
+      // With vertical pixel repeat, first enabling the overlay allocates a third
+      // scanline buffer, which is kept until the next init.
+      bool enable_text_overlay();
+      void disable_text_overlay();
+      void write_overlay_text(const Point &p, const char* text, TextColour colour = TEXT_WHITE);
+      void clear_overlay();
+      int get_overlay_width() const { return overlay_width; }
+      int get_overlay_height() const { return overlay_height; }
+
+      // Text mode font, used from the next init.  nullptr selects the built in
+      // font in 14 x 24 cells.  The font is not copied so must remain valid.
+      void set_text_font(const TextFont* font) { text_font = font; }
+
+      // Text mode character set, used from the next init.  With the built in
+      // font, box drawing, block and accented characters are generated and
+      // other CP437 symbols are blank.
+      void set_text_charset(TextCharset charset) { text_charset = charset; }
+
+      // Text mode.  The width and height passed to init are the size of the
+      // character grid, and the display resolution is chosen so the grid fits
+      // to within one character.  If no resolution fits, init returns false.
+      // 1280x720 gives 91 x 30 with the built in font.
       // Immediate writes to the active buffer instead of the back buffer
       void write_text(const Point &p, const char* text, TextColour colour = TEXT_WHITE, bool immediate = false);
 
+      // In MODE_TEXT_RGB111 each cell also has a background colour and
+      // attributes, a TextColour combined with TextAttribute flags.
+      // write_text without a background clears them to black with no attributes.
+      void write_text(const Point &p, const char* text, TextColour colour, TextColour background, uint8_t attributes = 0, bool immediate = false);
+
+      // Change the colours and attributes of l cells without changing the text,
+      // for example to highlight a selection.
+      void write_text_colour(const Point &p, uint l, TextColour colour, TextColour background, uint8_t attributes = 0, bool immediate = false);
+
+      // Text mode cursor, drawn by inverting part of the cell at the cursor
+      // position as it is displayed, so moving it needs no frame buffer writes.
+      // The cursor blinks on and off every blink_frames frames, or is steady if 0.
+      void set_cursor(const Point &p);
+      void set_cursor_shape(TextCursor shape, uint8_t blink_frames = 30);
+      Point get_cursor() const { return Point(cursor_x, cursor_y); }
+
+      // Scroll the text up by n rows, or down if n is negative, and clear the
+      // rows scrolled in.  Only the row origin of the buffer changes, the rest
+      // of the text is not moved.
+      void scroll_text(int n, bool immediate = false);
+
+      // Scroll only rows top to bottom inclusive, moving the text within them.
+      // The rows scrolled in are cleared to the background colour.
+      void scroll_text(int n, int top, int bottom, TextColour background = TEXT_BLACK, bool immediate = false);
+
+      // Move the text up by y pixels and left by x pixels, less than a cell,
+      // from the next vsync.  Combined with scroll_text this gives smooth
+      // scrolling.  The space left at the bottom and right is blank.
+      void set_text_fine_scroll(int x, int y);
+
+      // Copy the cells changed in the back buffer since the last update to the
+      // display buffer at the next vsync, instead of flipping.  Only text written
+      // through these methods is tracked, so the back buffer should not be
+      // flipped or written immediately while using updates.
+      // As with flip_async, call wait_for_flip before writing more text.
+      // Large updates are applied over a few frames, and are only complete
+      // when is_text_update_pending() returns false.
+      void update_text_async();
+      void update_text();
+      bool is_text_update_pending() const { return text_update_next; }
+
+      // Size of the character grid in text modes
+      int get_text_width() const { return frame_width; }
+      int get_text_height() const { return frame_height; }
+
       void clear();
 
       bool init(uint16_t width, uint16_t height, Mode mode = MODE_RGB565, Pinout pinout = {13, 15, 17, 19});
@@ -112,9 +313,17 @@ namespace pimoroni {
       void flip_async();
       void wait_for_flip();
 
+      Mode get_mode() const { return mode; }
+
+      // Address of a pixel in the back buffer, for drawing directly in pixel modes.
+      // Returns nullptr in tile map modes, where the frame buffer holds the map.
+      uint16_t* get_pixel_ptr16(const Point &p) const { return is_tilemap ? nullptr : point_to_ptr16(p); }
+      uint8_t* get_palette_pixel_ptr(const Point &p) const { return is_tilemap ? nullptr : point_to_ptr_palette(p); }
+
       // DMA handlers, should not be called externally
       void gfx_dma_handler();
       void text_dma_handler();
+      void dma_op_handler();
 
     private:
       RGB888 palette[PALETTE_SIZE];
@@ -131,13 +340,45 @@ namespace pimoroni {
         return frame_buffer_back + (p.y * (uint32_t)frame_width) + p.x;
       }
 
+      uint8_t* point_to_ptr_tile(const Point &p) const {
+        return frame_buffer_back + (p.y * (uint32_t)frame_width) + p.x;
+      }
+
       uint8_t* point_to_ptr_text(const Point &p, bool immediate) const {
-        const uint32_t offset = (p.y * (uint32_t)frame_width) + p.x;
+        int row = p.y + (immediate ? text_row_origin_display : text_row_origin_back);
+        if (row >= frame_height) row -= frame_height;
+        const uint32_t offset = (row * (uint32_t)frame_width) + p.x;
         if (immediate) return frame_buffer_display + offset;
         return frame_buffer_back + offset;
       }
 
       void display_setup_clock();
+      bool build_font_cache();
+      void render_overlay_line(uint32_t* line, int y);
+      bool add_overlay_line_buffer();
+      void render_cursor(uint32_t* line);
+      void mark_text_dirty(uint32_t cell, int len);
+      void copy_text_row(int dst_y, int src_y, bool immediate);
+      void clear_text_row(int y, TextColour background, bool immediate);
+      bool apply_text_update();
+      void shift_text_line(uint32_t* line, int words);
+      void update_cursor();
+      void render_text_line_rgb111(uint8_t* dst_ptr, const uint8_t* src_ptr, const uint32_t* font_line, uint32_t attr_mask);
+
+      uint32_t start_dma_op(uint8_t* write, uint32_t write_stride, const uint8_t* read, uint32_t read_stride,
+                            uint32_t fill, uint32_t row_bytes, uint32_t rows);
+
+      // Background DMA fills and copies, a row per transfer
+      int dma_op_channel = -1;
+      uint32_t dma_op_started = 0;
+      volatile uint32_t dma_op_done = 0;
+      volatile uint32_t dma_op_rows_left = 0;
+      uint32_t dma_op_fill = 0;
+      uintptr_t dma_op_read = 0;
+      uintptr_t dma_op_write = 0;
+      uint32_t dma_op_read_stride = 0;
+      uint32_t dma_op_write_stride = 0;
+      uint32_t dma_op_count = 0;
 
       // DMA scanline filling
       uint ch_num = 0;
@@ -149,6 +390,8 @@ namespace pimoroni {
       bool inited = false;
 
       uint32_t* line_buffers;
+      int line_buffer_words = 0;
+      int line_buffer_count = 0;
       const struct dvi_timing* timing_mode;
       int v_inactive_total;
       int v_total_active_lines;
@@ -157,6 +400,83 @@ namespace pimoroni {
       uint v_repeat_shift;
       int line_bytes_per_pixel;
 
+      void prepare_palette();
+
+      uint32_t display_palette_entry(RGB888 colour) const {
+        if (mode == MODE_PALETTE_RGB565) {
+          const uint32_t rgb565 = ((colour >> 8) & 0xF800) | ((colour >> 5) & 0x07E0) | ((colour >> 3) & 0x001F);
+          return rgb565 * 0x10001;
+        }
+        return colour;
+      }
+
+      uint32_t display_palettes[2][PALETTE_SIZE];
       uint32_t* display_palette = nullptr;
+      uint32_t* display_palette_back = nullptr;
+      bool palette_dirty = false;
+      uint32_t palette_generation = 0;
+      volatile bool palette_flip_next = false;
+
+      bool add_display_list_entry(const DisplayListEntry& entry);
+      void carry_display_list_palette();
+
+      DisplayListEntry* display_list_buffers = nullptr;
+      DisplayListEntry* display_list = nullptr;
+      DisplayListEntry* display_list_back = nullptr;
+      int display_list_len = 0;
+      int display_list_back_len = 0;
+      int display_list_pos = 0;
+      volatile bool display_list_flip_next = false;
+      int scroll_offset = 0;
+
+      const TextFont* text_font = nullptr;
+      int text_cell_width = 14;
+      int text_cell_height = 24;
+      TextCharset text_charset = CHARSET_ASCII;
+      uint8_t text_first_glyph = 33;
+      uint8_t text_glyph_count = 95;
+      int text_underline_row = 20;
+      uint32_t text_underline_bits[2];
+      uint8_t text_frame_count = 0;
+
+      // Buffer row displayed at the top of the screen, for each frame buffer
+      int text_row_origin_display = 0;
+      int text_row_origin_back = 0;
+
+      // One bit per cell changed since the last update
+      uint32_t* text_dirty = nullptr;
+      volatile bool text_update_next = false;
+      int text_update_word = 0;
+
+      int text_fine_x = 0;
+      int text_fine_y = 0;
+      int text_fine_x_next = 0;
+      int text_fine_y_next = 0;
+      uint32_t text_fine_x_mask = 0;
+      uint32_t text_fine_x_mask_next = 0;
+
+      TextCursor cursor_shape = CURSOR_NONE;
+      int cursor_x = 0;
+      int cursor_y = 0;
+      int cursor_first_row = 0;
+      int cursor_last_row = -1;
+      int cursor_columns = 0;
+      uint32_t cursor_mono_bits = 0;
+      uint8_t cursor_blink_frames = 30;
+      uint8_t cursor_blink_count = 0;
+      bool cursor_visible = false;
+
+      uint8_t* overlay_chars = nullptr;
+      uint8_t* overlay_colours = nullptr;
+      uint8_t* overlay_row_used = nullptr;
+      int overlay_width = 0;
+      int overlay_height = 0;
+      bool overlay_enabled = false;
+      bool overlay_active = false;
+
+      bool is_tilemap = false;
+      const uint8_t* tileset = nullptr;
+      uint tile_shift = 3;
+      uint tile_count = 0;
   };
 }
@@ -0,0 +1,442 @@
+#include <string.h>
+#include <algorithm>
+
+#include "pico/stdio.h"
+#include "pico/stdio/driver.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
+
+#include "dvhstx_terminal.hpp"
+
+using namespace pimoroni;
+
+// Queued output is applied every frame, this is often enough at any refresh rate
+#define TERMINAL_UPDATE_MS 8
+
+// Most queued bytes applied per update, so a burst of output, which may
+// scroll the screen on every line, is spread over several frames instead of
+// holding up the timer interrupt.
+#define TERMINAL_MAX_UPDATE_BYTES 256
+
+static const DVHSTX::TextColour ansi_colours[8] = {
+    DVHSTX::TEXT_BLACK, DVHSTX::TEXT_RED, DVHSTX::TEXT_GREEN, DVHSTX::TEXT_YELLOW,
+    DVHSTX::TEXT_BLUE, DVHSTX::TEXT_MAGENTA, DVHSTX::TEXT_CYAN, DVHSTX::TEXT_WHITE,
+};
+
+static DVHSTXTerminal* stdio_terminal = nullptr;
+
+static void terminal_out_chars(const char* buf, int len) {
+    if (stdio_terminal) stdio_terminal->write(buf, len);
+}
+
+static stdio_driver_t terminal_stdio_driver;
+
+bool DVHSTXTerminal::init(bool stdio)
+{
+    deinit();
+
+    const DVHSTX::Mode mode = display.get_mode();
+    if (mode != DVHSTX::MODE_TEXT_MONO && mode != DVHSTX::MODE_TEXT_RGB111) return false;
+
+    width = display.get_text_width();
+    height = display.get_text_height();
+    run = (char*)malloc((width + 1) * 2);
+    if (!run) return false;
+    blank_line = run + width + 1;
+    memset(blank_line, ' ', width);
+    blank_line[width] = 0;
+
+    queue_head = 0;
+    queue_tail = 0;
+    dropped = 0;
+    cursor_x = 0;
+    cursor_y = 0;
+    wrap_pending = false;
+    saved_x = 0;
+    saved_y = 0;
+    scroll_top = 0;
+    scroll_bottom = height - 1;
+    colour = DVHSTX::TEXT_WHITE;
+    background = DVHSTX::TEXT_BLACK;
+    attributes = 0;
+    state = STATE_NORMAL;
+    run_len = 0;
+
+    display.clear();
+    display.set_cursor({0, 0});
+    display.set_cursor_shape(DVHSTX::CURSOR_UNDERLINE);
+    display.update_text();
+
+    if (!add_repeating_timer_ms(TERMINAL_UPDATE_MS, timer_callback, this, &timer)) {
+        free(run);
+        run = nullptr;
+        return false;
+    }
+    inited = true;
+
+    // The timer applies output from an interrupt, which at the default priority
+    // would hold off the scanline interrupt, so let that pre-empt it.
+    irq_set_priority(DMA_IRQ_2, PICO_HIGHEST_IRQ_PRIORITY);
+
+    if (stdio) {
+        stdio_terminal = this;
+        terminal_stdio_driver.out_chars = terminal_out_chars;
+        stdio_set_driver_enabled(&terminal_stdio_driver, true);
+        stdio_enabled = true;
+    }
+
+    return true;
+}
+
+void DVHSTXTerminal::deinit()
+{
+    if (!inited) return;
+    inited = false;
+
+    if (stdio_enabled) {
+        stdio_set_driver_enabled(&terminal_stdio_driver, false);
+        stdio_terminal = nullptr;
+        stdio_enabled = false;
+    }
+    cancel_repeating_timer(&timer);
+    irq_set_priority(DMA_IRQ_2, PICO_DEFAULT_IRQ_PRIORITY);
+
+    free(run);
+    run = nullptr;
+    blank_line = nullptr;
+}
+
+void DVHSTXTerminal::write(const char* buf, int len)
+{
+    uint32_t head = queue_head;
+    const uint32_t tail = queue_tail;
+    const int space = QUEUE_SIZE - (head - tail);
+    if (len > space) {
+        dropped += len - space;
+        len = space;
+    }
+
+    for (int i = 0; i < len; ++i) {
+        queue[head++ & (QUEUE_SIZE - 1)] = buf[i];
+    }
+
+    // Make sure the characters are written before the consumer can see them
+    __dmb();
+    queue_head = head;
+}
+
+bool DVHSTXTerminal::timer_callback(repeating_timer_t* timer)
+{
+    ((DVHSTXTerminal*)timer->user_data)->update();
+    return true;
+}
+
+void DVHSTXTerminal::update()
+{
+    // Wait until the previous update has been copied to the display
+    if (!inited || display.is_text_update_pending()) return;
+
+    const uint32_t head = queue_head;
+    uint32_t tail = queue_tail;
+    if (head == tail) return;
+    __dmb();
+
+    const uint32_t end = tail + std::min(head - tail, (uint32_t)TERMINAL_MAX_UPDATE_BYTES);
+    while (tail != end) {
+        process(queue[tail++ & (QUEUE_SIZE - 1)]);
+    }
+    queue_tail = tail;
+    flush_run();
+
+    display.set_cursor({cursor_x, cursor_y});
+    display.update_text_async();
+}
+
+void DVHSTXTerminal::process(uint8_t c)
+{
+    switch (state) {
+    case STATE_NORMAL:
+        if (c < 0x20 || c == 0x7f) process_control(c);
+        else put_char(c);
+        break;
+    case STATE_ESCAPE:
+        process_escape(c);
+        break;
+    case STATE_CSI:
+        process_csi(c);
+        break;
+    }
+}
+
+void DVHSTXTerminal::process_control(uint8_t c)
+{
+    flush_run();
+
+    switch (c) {
+    case '\r':
+        move_cursor(0, cursor_y);
+        break;
+    case '\n':
+    case '\v':
+    case '\f':
+        move_cursor(0, cursor_y);
+        line_feed();
+        break;
+    case '\b':
+        move_cursor(cursor_x - 1, cursor_y);
+        break;
+    case '\t':
+        move_cursor((cursor_x + 8) & ~7, cursor_y);
+        break;
+    case 0x1b:
+        state = STATE_ESCAPE;
+        break;
+    default:
+        break;
+    }
+}
+
+void DVHSTXTerminal::process_escape(uint8_t c)
+{
+    state = STATE_NORMAL;
+
+    switch (c) {
+    case '[':
+        state = STATE_CSI;
+        num_params = 0;
+        params[0] = 0;
+        private_params = false;
+        break;
+    case '7':
+        saved_x = cursor_x;
+        saved_y = cursor_y;
+        break;
+    case '8':
+        move_cursor(saved_x, saved_y);
+        break;
+    case 'D':
+        line_feed();
+        break;
+    case 'E':
+        move_cursor(0, cursor_y);
+        line_feed();
+        break;
+    case 'M':
+        reverse_index();
+        break;
+    case 'c':
+        colour = DVHSTX::TEXT_WHITE;
+        background = DVHSTX::TEXT_BLACK;
+        attributes = 0;
+        scroll_top = 0;
+        scroll_bottom = height - 1;
+        erase(0, 0, width * height);
+        move_cursor(0, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+void DVHSTXTerminal::process_csi(uint8_t c)
+{
+    // Parameters
+    if (c >= '0' && c <= '9') {
+        if (num_params == 0) num_params = 1;
+        if (num_params <= MAX_PARAMS) {
+            params[num_params - 1] = std::min(params[num_params - 1] * 10 + (c - '0'), 9999);
+        }
+        return;
+    }
+    if (c == ';') {
+        if (num_params == 0) num_params = 1;
+        if (num_params < MAX_PARAMS) params[num_params] = 0;
+        ++num_params;
+        return;
+    }
+    if (c == '?') {
+        private_params = true;
+        return;
+    }
+    if (c < 0x40) return;
+    num_params = std::min(num_params, MAX_PARAMS);
+
+    // Final character
+    state = STATE_NORMAL;
+    switch (c) {
+    case 'A':
+        move_cursor(cursor_x, std::max(cursor_y - param(0, 1), cursor_y >= scroll_top ? scroll_top : 0));
+        break;
+    case 'B':
+        move_cursor(cursor_x, std::min(cursor_y + param(0, 1), cursor_y <= scroll_bottom ? scroll_bottom : height - 1));
+        break;
+    case 'C':
+        move_cursor(cursor_x + param(0, 1), cursor_y);
+        break;
+    case 'D':
+        move_cursor(cursor_x - param(0, 1), cursor_y);
+        break;
+    case 'E':
+        move_cursor(0, cursor_y + param(0, 1));
+        break;
+    case 'F':
+        move_cursor(0, cursor_y - param(0, 1));
+        break;
+    case 'G':
+        move_cursor(param(0, 1) - 1, cursor_y);
+        break;
+    case 'd':
+        move_cursor(cursor_x, param(0, 1) - 1);
+        break;
+    case 'H':
+    case 'f':
+        move_cursor(param(1, 1) - 1, param(0, 1) - 1);
+        break;
+    case 'J':
+        switch (param(0, 0)) {
+        case 0: erase(cursor_x, cursor_y, width * (height - cursor_y) - cursor_x); break;
+        case 1: erase(0, 0, width * cursor_y + cursor_x + 1); break;
+        default: erase(0, 0, width * height); break;
+        }
+        break;
+    case 'K':
+        switch (param(0, 0)) {
+        case 0: erase(cursor_x, cursor_y, width - cursor_x); break;
+        case 1: erase(0, cursor_y, cursor_x + 1); break;
+        default: erase(0, cursor_y, width); break;
+        }
+        break;
+    case 'X':
+        erase(cursor_x, cursor_y, std::min(param(0, 1), width - cursor_x));
+        break;
+    case 'L':
+        if (cursor_y >= scroll_top && cursor_y <= scroll_bottom) {
+            display.scroll_text(-param(0, 1), cursor_y, scroll_bottom, background);
+            move_cursor(0, cursor_y);
+        }
+        break;
+    case 'M':
+        if (cursor_y >= scroll_top && cursor_y <= scroll_bottom) {
+            display.scroll_text(param(0, 1), cursor_y, scroll_bottom, background);
+            move_cursor(0, cursor_y);
+        }
+        break;
+    case 'S':
+        display.scroll_text(param(0, 1), scroll_top, scroll_bottom, background);
+        break;
+    case 'T':
+        display.scroll_text(-param(0, 1), scroll_top, scroll_bottom, background);
+        break;
+    case 'm':
+        set_graphic_rendition();
+        break;
+    case 'r': {
+        const int top = param(0, 1) - 1;
+        const int bottom = std::min(param(1, height), height) - 1;
+        if (top < bottom) {
+            scroll_top = top;
+            scroll_bottom = bottom;
+            move_cursor(0, 0);
+        }
+        break;
+    }
+    case 's':
+        saved_x = cursor_x;
+        saved_y = cursor_y;
+        break;
+    case 'u':
+        move_cursor(saved_x, saved_y);
+        break;
+    case 'h':
+    case 'l':
+        if (private_params && param(0, 0) == 25) {
+            display.set_cursor_shape(c == 'h' ? DVHSTX::CURSOR_UNDERLINE : DVHSTX::CURSOR_NONE);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void DVHSTXTerminal::set_graphic_rendition()
+{
+    if (num_params == 0) num_params = 1;
+
+    for (int i = 0; i < num_params; ++i) {
+        const int p = params[i];
+        if (p == 0) {
+            colour = DVHSTX::TEXT_WHITE;
+            background = DVHSTX::TEXT_BLACK;
+            attributes = 0;
+        }
+        else if (p == 4) attributes |= DVHSTX::TEXT_UNDERLINE;
+        else if (p == 5 || p == 6) attributes |= DVHSTX::TEXT_BLINK;
+        else if (p == 7) attributes |= DVHSTX::TEXT_INVERSE;
+        else if (p == 24) attributes &= ~DVHSTX::TEXT_UNDERLINE;
+        else if (p == 25) attributes &= ~DVHSTX::TEXT_BLINK;
+        else if (p == 27) attributes &= ~DVHSTX::TEXT_INVERSE;
+        else if (p >= 30 && p <= 37) colour = ansi_colours[p - 30];
+        else if (p == 39) colour = DVHSTX::TEXT_WHITE;
+        else if (p >= 40 && p <= 47) background = ansi_colours[p - 40];
+        else if (p == 49) background = DVHSTX::TEXT_BLACK;
+        // Bright colours are shown as the normal colours
+        else if (p >= 90 && p <= 97) colour = ansi_colours[p - 90];
+        else if (p >= 100 && p <= 107) background = ansi_colours[p - 100];
+    }
+}
+
+void DVHSTXTerminal::put_char(uint8_t c)
+{
+    if (wrap_pending) {
+        flush_run();
+        cursor_x = 0;
+        wrap_pending = false;
+        line_feed();
+    }
+
+    if (run_len == 0) run_x = cursor_x;
+    run[run_len++] = c;
+
+    if (cursor_x == width - 1) wrap_pending = true;
+    else ++cursor_x;
+}
+
+void DVHSTXTerminal::flush_run()
+{
+    if (run_len == 0) return;
+
+    run[run_len] = 0;
+    display.write_text({run_x, cursor_y}, run, colour, background, attributes);
+    run_len = 0;
+}
+
+void DVHSTXTerminal::line_feed()
+{
+    if (cursor_y == scroll_bottom) display.scroll_text(1, scroll_top, scroll_bottom, background);
+    else if (cursor_y < height - 1) ++cursor_y;
+}
+
+void DVHSTXTerminal::reverse_index()
+{
+    if (cursor_y == scroll_top) display.scroll_text(-1, scroll_top, scroll_bottom, background);
+    else if (cursor_y > 0) --cursor_y;
+}
+
+// Erase len cells from x, y onwards, continuing onto the following rows
+void DVHSTXTerminal::erase(int x, int y, int len)
+{
+    while (len > 0 && y < height) {
+        const int row_len = std::min(len, width - x);
+        display.write_text({x, y}, &blank_line[width - row_len], colour, background);
+        len -= row_len;
+        x = 0;
+        ++y;
+    }
+}
+
+void DVHSTXTerminal::move_cursor(int x, int y)
+{
+    cursor_x = std::max(0, std::min(x, width - 1));
+    cursor_y = std::max(0, std::min(y, height - 1));
+    wrap_pending = false;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "dvhstx.hpp"
+
+// ANSI terminal on the DVHSTX text modes, which can be used as a pico stdio driver
+
+namespace pimoroni {
+
+  // Terminal interpreting the common ANSI / VT100 escape sequences: cursor
+  // movement, SGR colours and attributes, erase in display and line, insert
+  // and delete lines, scroll regions and cursor save and restore.
+  // Line feed also returns the cursor to the start of the line.
+  //
+  // Output is queued, and applied to the back text buffer by a timer at most
+  // once per frame, a limited number of bytes at a time, then shown with
+  // DVHSTX::update_text_async().  So printing is cheap and never tears, but if
+  // more is printed than the queue holds before it is applied the excess is
+  // dropped.
+  class DVHSTXTerminal {
+  public:
+    static constexpr int QUEUE_SIZE = 4096;  // Must be a power of 2
+    static constexpr int MAX_PARAMS = 8;
+
+    DVHSTXTerminal(DVHSTX& display) : display(display) {}
+    ~DVHSTXTerminal() { deinit(); }
+
+    // The display must already be initialised in a text mode.
+    // With stdio set the terminal is also registered as a stdio driver.
+    // While it runs the display's scanline interrupt, DMA_IRQ_2, is raised to
+    // the highest priority so the terminal's timer can't delay it.
+    bool init(bool stdio = true);
+    void deinit();
+
+    // Queue output.  Only one core or interrupt should write at a time,
+    // which stdio ensures.
+    void write(const char* buf, int len);
+
+    // Apply queued output now if the previous update has been shown.
+    // This is called from a timer, so is only needed when the timer can't run.
+    void update();
+
+    uint32_t get_dropped_count() const { return dropped; }
+
+  private:
+    enum ParseState {
+      STATE_NORMAL,
+      STATE_ESCAPE,
+      STATE_CSI,
+    };
+
+    static bool timer_callback(repeating_timer_t* timer);
+
+    void process(uint8_t c);
+    void process_control(uint8_t c);
+    void process_escape(uint8_t c);
+    void process_csi(uint8_t c);
+    void set_graphic_rendition();
+    void put_char(uint8_t c);
+    void flush_run();
+    void line_feed();
+    void reverse_index();
+    void erase(int x, int y, int len);
+    void move_cursor(int x, int y);
+    int param(int i, int def) const { return (i < num_params && params[i] > 0) ? params[i] : def; }
+
+    DVHSTX& display;
+    repeating_timer_t timer;
+    bool inited = false;
+    bool stdio_enabled = false;
+
+    uint8_t queue[QUEUE_SIZE];
+    volatile uint32_t queue_head = 0;
+    volatile uint32_t queue_tail = 0;
+    uint32_t dropped = 0;
+
+    int width = 0;
+    int height = 0;
+    int cursor_x = 0;
+    int cursor_y = 0;
+    bool wrap_pending = false;
+    int saved_x = 0;
+    int saved_y = 0;
+    int scroll_top = 0;
+    int scroll_bottom = 0;
+
+    DVHSTX::TextColour colour = DVHSTX::TEXT_WHITE;
+    DVHSTX::TextColour background = DVHSTX::TEXT_BLACK;
+    uint8_t attributes = 0;
+
+    ParseState state = STATE_NORMAL;
+    int params[MAX_PARAMS];
+    int num_params = 0;
+    bool private_params = false;
+
+    // Printable characters are collected and written a run at a time
+    char* run = nullptr;
+    int run_x = 0;
+    int run_len = 0;
+    char* blank_line = nullptr;
+  };
+}
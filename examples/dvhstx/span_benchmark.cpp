@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include "drivers/dvhstx/dvhstx.hpp"
+
+// Times the RGB565 span functions against simple per pixel loops, which is
+// how they used to be written, drawing spans of various lengths and offsets.
+
+using namespace pimoroni;
+
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 180
+
+static DVHSTX display;
+
+// Targets for the per pixel loops, the same size as the frame buffer
+static uint16_t reference_frame[FRAME_WIDTH * FRAME_HEIGHT];
+static uint16_t span_data[FRAME_WIDTH];
+
+static void __attribute__((noinline)) reference_fill(uint16_t* ptr, uint l, uint16_t colour) {
+    for (uint i = 0; i < l; ++i) ptr[i] = colour;
+}
+
+static void __attribute__((noinline)) reference_copy(uint16_t* dst, const uint16_t* src, uint l) {
+    for (uint i = 0; i < l; ++i) dst[i] = src[i];
+}
+
+static const int span_lengths[] = {4, 16, 64, 320};
+
+// Each test draws a span of length l on every line, starting at x = 0..3
+// to cover each alignment, and returns the time in us.
+static int time_fill(int l, bool reference) {
+    absolute_time_t start_time = get_absolute_time();
+    for (int x = 0; x < 4; ++x) {
+        const int len = std::min(l, FRAME_WIDTH - x);
+        for (int y = 0; y < FRAME_HEIGHT; ++y) {
+            if (reference) reference_fill(&reference_frame[y * FRAME_WIDTH + x], len, 0x1234);
+            else display.write_pixel_span({x, y}, len, (uint16_t)0x1234);
+        }
+    }
+    return (int)absolute_time_diff_us(start_time, get_absolute_time());
+}
+
+static int time_write(int l, bool reference) {
+    absolute_time_t start_time = get_absolute_time();
+    for (int x = 0; x < 4; ++x) {
+        const int len = std::min(l, FRAME_WIDTH - x);
+        for (int y = 0; y < FRAME_HEIGHT; ++y) {
+            if (reference) reference_copy(&reference_frame[y * FRAME_WIDTH + x], span_data, len);
+            else display.write_pixel_span({x, y}, len, span_data);
+        }
+    }
+    return (int)absolute_time_diff_us(start_time, get_absolute_time());
+}
+
+static int time_read(int l, bool reference) {
+    absolute_time_t start_time = get_absolute_time();
+    for (int x = 0; x < 4; ++x) {
+        const int len = std::min(l, FRAME_WIDTH - x);
+        for (int y = 0; y < FRAME_HEIGHT; ++y) {
+            if (reference) reference_copy(span_data, &reference_frame[y * FRAME_WIDTH + x], len);
+            else display.read_pixel_span({x, y}, len, span_data);
+        }
+    }
+    return (int)absolute_time_diff_us(start_time, get_absolute_time());
+}
+
+int main()
+{
+    stdio_init_all();
+
+    display.init(FRAME_WIDTH, FRAME_HEIGHT, DVHSTX::MODE_RGB565);
+    display.clear();
+    display.flip_now();
+
+    for (int i = 0; i < FRAME_WIDTH; ++i) span_data[i] = i * 0x0821;
+
+    while (true) {
+        printf("Span length:   fill (loop)   write (loop)   read (loop)  us\n");
+        for (int l : span_lengths) {
+            printf("%11d: %6d (%6d)  %6d (%6d)  %6d (%6d)\n", l,
+                time_fill(l, false), time_fill(l, true),
+                time_write(l, false), time_write(l, true),
+                time_read(l, false), time_read(l, true));
+        }
+        printf("\n");
+
+        display.flip_blocking();
+        sleep_ms(2000);
+    }
+}
@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include "drivers/dvhstx/dvhstx.hpp"
+#include "drivers/dvhstx/dvhstx_terminal.hpp"
+
+using namespace pimoroni;
+
+#define FRAME_WIDTH 91
+#define FRAME_HEIGHT 30
+
+static DVHSTX display;
+static DVHSTXTerminal terminal(display);
+
+int main()
+{
+    stdio_init_all();
+
+    display.init(FRAME_WIDTH, FRAME_HEIGHT, DVHSTX::MODE_TEXT_RGB111);
+    terminal.init();
+
+    // Fixed status line at the top, log scrolling below it
+    printf("\033[2;%dr", FRAME_HEIGHT);
+    int line = 0;
+    while(1) {
+      printf("\0337\033[1;1H\033[44;37m\033[K Lines: %d  Dropped: %d\033[0m\0338", line, (int)terminal.get_dropped_count());
+      printf("\033[3%dmLog line %d\033[0m: the quick brown fox jumps over the lazy dog\n", 1 + (line % 7), line);
+      ++line;
+      sleep_ms(2);
+    }
+}
@@ -15,7 +15,7 @@ void fill_text(int frame)
 {
     char buf[128];
     sprintf(buf, "Hello World!  Frame: %d", frame);
-    display.write_text({0,0}, buf);
+    display.write_text({0,0}, buf, DVHSTX::TEXT_WHITE, DVHSTX::TEXT_BLUE);
 
     for (int i = 0; i < 0x7f; ++i) {
       buf[i] = i;
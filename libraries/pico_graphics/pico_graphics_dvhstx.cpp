@@ -0,0 +1,339 @@
+#include "pico_graphics_dvhstx.hpp"
+
+namespace pimoroni {
+
+    // A non-horizontal polygon edge, covering lines y_start to y_end, with x
+    // in 16.16 fixed point on the current line.  x and dx are 64 bit so any
+    // int32 coordinates fit.
+    struct PolygonEdge {
+        int32_t y_start;
+        int32_t y_end;
+        int64_t x;
+        int64_t dx;
+    };
+
+    // Drawing is single threaded, so the edge tables can be shared
+    static PolygonEdge polygon_edges[PicoGraphicsDVHSTX::MAX_POLYGON_EDGES];
+    static uint16_t active_edges[PicoGraphicsDVHSTX::MAX_POLYGON_EDGES];
+
+    void PicoGraphicsDVHSTX::fill_polygon(const Point *points, uint count) {
+        if(clip.empty()) return;
+        if(count > MAX_POLYGON_EDGES) {
+            // Too many edges for the table
+            PicoGraphics::polygon(std::vector<Point>(points, points + count));
+            return;
+        }
+
+        // Build the edge table.  As for PicoGraphics::polygon, an edge from
+        // y0 to y1 covers the lines y0 + 1 to y1.
+        int num_edges = 0;
+        for(uint i = 0; i < count; i++) {
+            Point p0 = points[i];
+            Point p1 = points[(i + 1) % count];
+            if(p0.y == p1.y) continue;
+            if(p0.y > p1.y) std::swap(p0, p1);
+
+            PolygonEdge &edge = polygon_edges[num_edges++];
+            edge.dx = (((int64_t)p1.x - p0.x) * 65536) / ((int64_t)p1.y - p0.y);
+            edge.y_start = p0.y + 1;
+            edge.y_end = p1.y;
+            edge.x = (int64_t)p0.x * 65536 + edge.dx;
+        }
+        if(num_edges < 2) return;
+
+        std::sort(polygon_edges, polygon_edges + num_edges, [](const PolygonEdge &a, const PolygonEdge &b) {
+            return a.y_start < b.y_start;
+        });
+
+        int32_t y_end = polygon_edges[0].y_end;
+        for(int i = 1; i < num_edges; i++) y_end = std::max(y_end, polygon_edges[i].y_end);
+        y_end = std::min(y_end, clip.y + clip.h - 1);
+
+        const int32_t clip_x_end = clip.x + clip.w - 1;
+        int next_edge = 0;
+        int num_active = 0;
+        for(int32_t y = std::max(polygon_edges[0].y_start, clip.y); y <= y_end; y++) {
+            // Add edges starting on or above this line, stepped down to it
+            for(; next_edge < num_edges && polygon_edges[next_edge].y_start <= y; next_edge++) {
+                PolygonEdge &edge = polygon_edges[next_edge];
+                if(edge.y_end < y) continue;
+                // Less than the edge's height, so this is at most its width in 16.16
+                edge.x += (y - edge.y_start) * edge.dx;
+                active_edges[num_active++] = next_edge;
+            }
+
+            // Remove finished edges, and sort the rest by x.  The order rarely
+            // changes between lines, so an insertion sort is quick.
+            int n = 0;
+            for(int i = 0; i < num_active; i++) {
+                const uint16_t e = active_edges[i];
+                if(polygon_edges[e].y_end < y) continue;
+
+                int j = n++;
+                for(; j > 0 && polygon_edges[active_edges[j - 1]].x > polygon_edges[e].x; j--) {
+                    active_edges[j] = active_edges[j - 1];
+                }
+                active_edges[j] = e;
+            }
+            num_active = n;
+
+            for(int i = 0; i + 1 < num_active; i += 2) {
+                const int32_t x0 = std::max(polygon_edges[active_edges[i]].x >> 16, (int64_t)clip.x);
+                const int32_t x1 = std::min(polygon_edges[active_edges[i + 1]].x >> 16, (int64_t)clip_x_end);
+                if(x0 <= x1) set_pixel_span(Point(x0, y), x1 - x0 + 1);
+            }
+
+            for(int i = 0; i < num_active; i++) {
+                polygon_edges[active_edges[i]].x += polygon_edges[active_edges[i]].dx;
+            }
+        }
+    }
+
+    void PicoGraphicsDVHSTX::clear_depth_buffer() {
+        if(depth_buffer) std::fill_n(depth_buffer, bounds.w * bounds.h, 0xFFFF);
+    }
+
+    // Value of a vertex attribute at the centre of pixel (x, y), and its
+    // change per pixel in x, in fixed point with frac_bits fractional bits.
+    // Coordinates are relative to v0 and det is twice the triangle's area.
+    static inline void triangle_gradient(int32_t a0, int32_t a1, int32_t a2, int32_t dx1, int32_t dy1, int32_t dx2, int32_t dy2,
+                                         int64_t det, int32_t x, int32_t y, int frac_bits, int32_t &value, int32_t &step) {
+        const int64_t dadx = (((int64_t)(a1 - a0) * dy2 - (int64_t)(a2 - a0) * dy1) << frac_bits) / det;
+        const int64_t dady = (((int64_t)(a2 - a0) * dx1 - (int64_t)(a1 - a0) * dx2) << frac_bits) / det;
+        value = (int32_t)(((int64_t)a0 << frac_bits) + dadx * x + dady * y + ((dadx + dady) >> 1));
+        step = (int32_t)dadx;
+    }
+
+    static inline int64_t floor_div(int64_t n, int64_t d) {
+        return (n >= 0) ? n / d : -((-n + d - 1) / d);
+    }
+
+    static inline int64_t ceil_div(int64_t n, int64_t d) {
+        return (n >= 0) ? (n + d - 1) / d : -((-n) / d);
+    }
+
+    // Clamp both ends of a span of an interpolated value into range, so
+    // rounding at the triangle edges can't overflow it.
+    static inline void clamp_span(int32_t &value, int32_t &step, uint l, int32_t max) {
+        if(l <= 1) {
+            value = std::clamp(value, 0, max);
+            return;
+        }
+        const int32_t end = std::clamp(value + step * (int32_t)(l - 1), 0, max);
+        value = std::clamp(value, 0, max);
+        step = (end - value) / (int32_t)(l - 1);
+    }
+
+    void PicoGraphicsDVHSTX::triangle_3d(Vertex3D v0, Vertex3D v1, Vertex3D v2, bool smooth) {
+        // Edge functions are evaluated at pixel centres, with coordinates
+        // doubled to keep them integer.  Wind the triangle clockwise on screen.
+        int64_t det = (int64_t)(v1.x - v0.x) * (v2.y - v0.y) - (int64_t)(v2.x - v0.x) * (v1.y - v0.y);
+        if(det == 0) return;
+        if(det < 0) {
+            std::swap(v1, v2);
+            det = -det;
+        }
+
+        const Rect box = Rect(std::min({v0.x, v1.x, v2.x}), std::min({v0.y, v1.y, v2.y}),
+                              std::max({v0.x, v1.x, v2.x}) - std::min({v0.x, v1.x, v2.x}) + 1,
+                              std::max({v0.y, v1.y, v2.y}) - std::min({v0.y, v1.y, v2.y}) + 1).intersection(clip);
+        if(box.empty()) return;
+
+        // For each edge, E(x, y) = a * (2x + 1) + b * (2y + 1) + c is positive
+        // inside the triangle.  The top left fill rule is applied with a bias,
+        // so triangles sharing an edge don't both draw it.
+        const Vertex3D *v[3] = {&v0, &v1, &v2};
+        int64_t edge_a[3], edge_b[3], edge_c[3];
+        for(int i = 0; i < 3; i++) {
+            const Vertex3D &p = *v[i];
+            const Vertex3D &q = *v[(i + 1) % 3];
+            edge_a[i] = -(q.y - p.y);
+            edge_b[i] = q.x - p.x;
+            edge_c[i] = 2 * ((int64_t)(q.y - p.y) * p.x - (int64_t)(q.x - p.x) * p.y);
+            const bool top_left = (q.y == p.y && q.x > p.x) || (q.y < p.y);
+            if(!top_left) edge_c[i] -= 1;
+        }
+
+        for(int32_t y = box.y; y < box.y + box.h; y++) {
+            // Find the span of the line inside all three edges
+            int32_t x_start = box.x;
+            int32_t x_end = box.x + box.w - 1;
+            for(int i = 0; i < 3 && x_start <= x_end; i++) {
+                // E >= 0 where 2a * x >= -(a + b * (2y + 1) + c)
+                const int64_t n = -(edge_a[i] + edge_b[i] * (2 * y + 1) + edge_c[i]);
+                const int64_t d = edge_a[i] * 2;
+                if(d > 0) x_start = std::max<int64_t>(x_start, ceil_div(n, d));
+                else if(d < 0) x_end = std::min<int64_t>(x_end, floor_div(-n, -d));
+                else if(n > 0) x_end = x_start - 1;
+            }
+            if(x_start > x_end) continue;
+
+            const uint l = x_end - x_start + 1;
+            const int32_t dx1 = v1.x - v0.x, dy1 = v1.y - v0.y;
+            const int32_t dx2 = v2.x - v0.x, dy2 = v2.y - v0.y;
+            const int32_t rx = x_start - v0.x, ry = y - v0.y;
+
+            ShadeSpan s;
+            triangle_gradient(v0.z, v1.z, v2.z, dx1, dy1, dx2, dy2, det, rx, ry, 8, s.z, s.dz);
+            clamp_span(s.z, s.dz, l, 0xFFFF << 8);
+            if(smooth) {
+                triangle_gradient(v0.colour.r, v1.colour.r, v2.colour.r, dx1, dy1, dx2, dy2, det, rx, ry, 16, s.r, s.dr);
+                triangle_gradient(v0.colour.g, v1.colour.g, v2.colour.g, dx1, dy1, dx2, dy2, det, rx, ry, 16, s.g, s.dg);
+                triangle_gradient(v0.colour.b, v1.colour.b, v2.colour.b, dx1, dy1, dx2, dy2, det, rx, ry, 16, s.b, s.db);
+                clamp_span(s.r, s.dr, l, 255 << 16);
+                clamp_span(s.g, s.dg, l, 255 << 16);
+                clamp_span(s.b, s.db, l, 255 << 16);
+            }
+            else {
+                s.r = v0.colour.r << 16; s.dr = 0;
+                s.g = v0.colour.g << 16; s.dg = 0;
+                s.b = v0.colour.b << 16; s.db = 0;
+            }
+
+            uint16_t *depth = depth_buffer ? &depth_buffer[y * bounds.w + x_start] : nullptr;
+            shade_span_3d(Point(x_start, y), l, depth, s);
+        }
+    }
+
+    // A horizontal run of pixels in an unscaled glyph
+    struct GlyphSpan {
+        uint8_t x;
+        uint8_t y;
+        uint8_t len;
+    };
+
+    static const int GLYPH_CACHE_CHARS = 95;  // ' ' to '~'
+    static const int MAX_GLYPH_SPANS = 2048;
+
+    static const bitmap::font_t *glyph_cache_font = nullptr;
+    static GlyphSpan glyph_spans[MAX_GLYPH_SPANS];
+    static int num_glyph_spans = 0;
+    static bool glyph_cache_full = false;
+    static int16_t glyph_start[GLYPH_CACHE_CHARS];
+    static uint8_t glyph_span_count[GLYPH_CACHE_CHARS];
+
+    // Rasterise a glyph with bitmap::character and store its runs.
+    // Returns false if the cache is full.  Once a glyph hasn't fitted no more
+    // are tried, so glyphs aren't rasterised again on every call.
+    static bool cache_glyph(const bitmap::font_t *font, char c) {
+        const int i = c - ' ';
+        if(glyph_start[i] >= 0) return true;
+        if(glyph_cache_full) return false;
+
+        uint32_t rows[32] = {0};
+        bitmap::character(font, [&rows](int32_t x, int32_t y, int32_t w, int32_t h) {
+            for(int32_t cy = std::max(y, 0); cy < std::min(y + h, 32); cy++) {
+                for(int32_t cx = std::max(x, 0); cx < std::min(x + w, 32); cx++) {
+                    rows[cy] |= 1u << cx;
+                }
+            }
+        }, c, 0, 0, 1);
+
+        const int start = num_glyph_spans;
+        for(int y = 0; y < 32; y++) {
+            uint32_t row = rows[y];
+            while(row) {
+                const int x = __builtin_ctz(row);
+                const uint32_t gaps = ~(row >> x);
+                const int len = gaps ? __builtin_ctz(gaps) : 32;
+                if(num_glyph_spans == MAX_GLYPH_SPANS || num_glyph_spans - start == 255) {
+                    num_glyph_spans = start;
+                    glyph_cache_full = true;
+                    return false;
+                }
+                glyph_spans[num_glyph_spans++] = {(uint8_t)x, (uint8_t)y, (uint8_t)len};
+                row &= (len == 32) ? 0 : ~(((1u << len) - 1) << x);
+            }
+        }
+
+        glyph_start[i] = start;
+        glyph_span_count[i] = num_glyph_spans - start;
+        return true;
+    }
+
+    void PicoGraphicsDVHSTX::text(const std::string_view &t, const Point &p, int32_t wrap, float s, float a, uint8_t letter_spacing, bool fixed_width) {
+        bool cacheable = bitmap_font != nullptr && ((int32_t)a % 360) == 0;
+        for(size_t i = 0; i < t.length() && cacheable; i++) {
+            cacheable = t[i] == '\n' || (t[i] >= ' ' && t[i] <= '~');
+        }
+        if(!cacheable) {
+            PicoGraphics::text(t, p, wrap, s, a, letter_spacing, fixed_width);
+            return;
+        }
+
+        const bitmap::font_t *font = bitmap_font;
+        if(glyph_cache_font != font) {
+            glyph_cache_font = font;
+            num_glyph_spans = 0;
+            glyph_cache_full = false;
+            std::fill_n(glyph_start, GLYPH_CACHE_CHARS, -1);
+        }
+
+        const uint8_t scale = std::max(1.0f, s);
+        const int32_t clip_x_end = clip.x + clip.w;
+        const int32_t clip_y_end = clip.y + clip.h;
+
+        auto draw_glyph = [&](char c, int32_t x, int32_t y) {
+            if(!cache_glyph(font, c)) {
+                bitmap::character(font, [this](int32_t x, int32_t y, int32_t w, int32_t h) {
+                    rectangle(Rect(x, y, w, h));
+                }, c, x, y, scale);
+                return;
+            }
+
+            const GlyphSpan *span = &glyph_spans[glyph_start[c - ' ']];
+            const GlyphSpan *end = span + glyph_span_count[c - ' '];
+            for(; span < end; span++) {
+                const int32_t x0 = std::max(x + span->x * scale, clip.x);
+                const int32_t x1 = std::min(x + (span->x + span->len) * scale, clip_x_end);
+                if(x0 >= x1) continue;
+
+                const int32_t y0 = std::max(y + span->y * scale, clip.y);
+                const int32_t y1 = std::min(y + (span->y + 1) * scale, clip_y_end);
+                for(int32_t sy = y0; sy < y1; sy++) {
+                    set_pixel_span(Point(x0, sy), x1 - x0);
+                }
+            }
+        };
+
+        // Lay out words as bitmap::text does
+        uint32_t co = 0, lo = 0;
+        size_t i = 0;
+        while(i < t.length()) {
+            size_t next_space = t.find(' ', i + 1);
+            if(next_space == std::string_view::npos) next_space = t.length();
+            size_t next_linebreak = t.find('\n', i + 1);
+            if(next_linebreak == std::string_view::npos) next_linebreak = t.length();
+            const size_t next_break = std::min(next_space, next_linebreak);
+
+            uint16_t word_width = 0;
+            // Measured as bitmap::text does, so wrapping matches the uncached path
+            for(size_t j = i; j < next_break; j++) {
+                word_width += bitmap::measure_character(font, t[j], scale, unicode_sorta::PAGE_195, fixed_width);
+                word_width += letter_spacing * scale;
+            }
+
+            if(co != 0 && co + word_width > (uint32_t)wrap) {
+                co = 0;
+                lo += (font->height + 1) * scale;
+            }
+
+            for(size_t j = i; j < std::min(next_break + 1, t.length()); j++) {
+                if(t[j] == '\n') {
+                    lo += (font->height + 1) * scale;
+                    co = 0;
+                }
+                else if(t[j] == ' ') {
+                    co += font->widths[0] * scale;
+                }
+                else {
+                    draw_glyph(t[j], p.x + co, p.y + lo);
+                    co += bitmap::measure_character(font, t[j], scale, unicode_sorta::PAGE_195, fixed_width);
+                    co += letter_spacing * scale;
+                }
+            }
+
+            i = next_break + 1;
+        }
+    }
+}
@@ -9,13 +9,62 @@ namespace pimoroni {
 
   class PicoGraphicsDVHSTX : public PicoGraphics {
     public:
+      // Longest run of pixels blended at once by render_tile
+      static const int TILE_SPAN = 64;
+
+      // Most edges fill_polygon will use
+      static const int MAX_POLYGON_EDGES = 256;
+
+      // Triangle corner for triangle_3d.  Smaller z is nearer.
+      struct Vertex3D {
+        int32_t x;
+        int32_t y;
+        uint16_t z;
+        RGB colour;
+      };
+
+      // Span of a 3D triangle.  z is 24.8 and the colour channels 16.16 fixed
+      // point, stepping by the d values at each pixel.
+      struct ShadeSpan {
+        int32_t z, dz;
+        int32_t r, dr;
+        int32_t g, dg;
+        int32_t b, db;
+      };
+
       DVHSTX &driver;
       BlendMode blend_mode = BlendMode::TARGET;
+      uint16_t *depth_buffer = nullptr;
 
       void set_blend_mode(BlendMode mode) {
         blend_mode = mode;
       }
 
+      // Fill a polygon with the even-odd rule, clipped to the clip rect.  Edges are
+      // kept in an active edge table, so each line only steps the edges crossing
+      // it, and spans are drawn with set_pixel_span.  No memory is allocated,
+      // except that more than MAX_POLYGON_EDGES points fall back to polygon().
+      void fill_polygon(const Point *points, uint count);
+
+      // Text, as PicoGraphics::text.  Unrotated ASCII in a bitmap font is drawn
+      // from a cache of each glyph's horizontal runs, a span per run per line,
+      // instead of a rectangle per pixel.  The cache holds one font and is
+      // independent of the scale and pen.
+      void text(const std::string_view &t, const Point &p, int32_t wrap, float s = 2.0f, float a = 0.0f, uint8_t letter_spacing = 1, bool fixed_width = false);
+
+      // Depth buffer for triangle_3d, one uint16_t for each pixel in bounds.
+      // Without a depth buffer triangles are drawn in order.
+      void set_depth_buffer(uint16_t *buffer) { depth_buffer = buffer; }
+      void clear_depth_buffer();
+
+      // Fill a triangle, shading from the vertex colours (smooth) or with the
+      // colour of v0, and drawing only pixels nearer than the depth buffer.
+      void triangle_3d(Vertex3D v0, Vertex3D v1, Vertex3D v2, bool smooth = true);
+
+      // Draw a depth tested span for triangle_3d directly into the back buffer.
+      // depth is the depth buffer entry for p, or nullptr.
+      virtual void shade_span_3d(const Point &p, uint l, uint16_t *depth, const ShadeSpan &s) {}
+
       virtual void set_depth(uint8_t new_depth) {}
       virtual void set_bg(uint c) {};
 
@@ -47,6 +96,7 @@ namespace pimoroni {
       bool supports_alpha_blend() override {return true;}
 
       bool render_tile(const Tile *tile) override;
+      void shade_span_3d(const Point &p, uint l, uint16_t *depth, const ShadeSpan &s) override;
 
       static size_t buffer_size(uint w, uint h) {
         return w * h * sizeof(RGB565);
@@ -60,9 +110,24 @@ namespace pimoroni {
       uint8_t depth = 0;
       bool used[palette_size];
 
+      // Dither candidates for each RGB333 colour, built as each is first used
       std::array<std::array<uint8_t, 16>, 512> candidate_cache;
+      std::array<uint32_t, 512 / 32> candidate_cache_valid;
       std::array<uint8_t, 16> candidates;
       bool cache_built = false;
+      uint32_t candidate_generation = 0;
+
+      // Nearest palette entry for each RGB555 colour, filled in as colours are
+      // looked up and cleared when the palette changes.  The cells holding
+      // palette colours are filled in up front, so exact matches are kept.
+      // Both caches are rebuilt when the driver's palette generation changes,
+      // so palette changes made directly on the driver are picked up too.
+      // Display list palette entries only affect the output, not the pens.
+      RGB palette_rgb[palette_size];
+      std::array<uint8_t, 32768> nearest_cache;
+      std::array<uint32_t, 32768 / 32> nearest_cache_valid;
+      bool palette_rgb_built = false;
+      uint32_t palette_generation = 0;
 
       PicoGraphics_PenDVHSTX_P8(uint16_t width, uint16_t height, DVHSTX &dv_display);
       void set_pen(uint c) override;
@@ -78,8 +143,16 @@ namespace pimoroni {
 
       void set_pixel(const Point &p) override;
       void set_pixel_span(const Point &p, uint l) override;
+      void build_palette_rgb();
+      uint8_t get_nearest_pen(uint8_t r, uint8_t g, uint8_t b);
       void get_dither_candidates(const RGB &col, const RGB *palette, size_t len, std::array<uint8_t, 16> &candidates);
       void set_pixel_dither(const Point &p, const RGB &c) override;
+      void set_pixel_span_dither(const Point &p, uint l, const RGB &c);
+      const std::array<uint8_t, 16>& get_dither_candidates(const RGB &c);
+      uint8_t get_dither_colour(const Point &p, const RGB &c);
+
+      bool render_tile(const Tile *tile) override;
+      void shade_span_3d(const Point &p, uint l, uint16_t *depth, const ShadeSpan &s) override;
 
       static size_t buffer_size(uint w, uint h) {
           return w * h;
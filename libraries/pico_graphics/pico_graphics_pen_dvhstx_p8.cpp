@@ -23,18 +23,49 @@ namespace pimoroni {
         depth = new_depth > 0 ? 1 : 0;
     }
     void PicoGraphics_PenDVHSTX_P8::set_pen(uint8_t r, uint8_t g, uint8_t b) {
+        color = get_nearest_pen(r, g, b);
+    }
+    void PicoGraphics_PenDVHSTX_P8::build_palette_rgb() {
+        if(palette_rgb_built && palette_generation == driver.get_palette_generation()) return;
+        palette_generation = driver.get_palette_generation();
+
         RGB888 *driver_palette = driver.get_palette();
-        RGB palette[palette_size];
         for(auto i = 0u; i < palette_size; i++) {
-            palette[i] = RGB((uint)driver_palette[i]);
+            palette_rgb[i] = RGB((uint)driver_palette[i]);
         }
+        nearest_cache_valid.fill(0);
 
-        int pen = RGB(r, g, b).closest(palette, palette_size);
-        if(pen != -1) color = pen;
+        // A colour in the palette is its own nearest pen, even if another entry
+        // is closer to the centre of its RGB555 cell, so seed each palette
+        // colour's cell with it.  The lowest entry wins, as with closest().
+        for(auto i = 0u; i < palette_size; i++) {
+            const RGB &c = palette_rgb[i];
+            const uint key = ((c.r & 0xF8) << 7) | ((c.g & 0xF8) << 2) | (c.b >> 3);
+            const uint32_t valid_bit = 1u << (key & 31);
+            if(nearest_cache_valid[key >> 5] & valid_bit) continue;
+            nearest_cache[key] = i;
+            nearest_cache_valid[key >> 5] |= valid_bit;
+        }
+        palette_rgb_built = true;
+    }
+    uint8_t PicoGraphics_PenDVHSTX_P8::get_nearest_pen(uint8_t r, uint8_t g, uint8_t b) {
+        build_palette_rgb();
+
+        const uint key = ((r & 0xF8) << 7) | ((g & 0xF8) << 2) | (b >> 3);
+        const uint32_t valid_bit = 1u << (key & 31);
+        if(!(nearest_cache_valid[key >> 5] & valid_bit)) {
+            // Match the centre of the RGB555 cell so the result doesn't depend
+            // on which colour in the cell was looked up first.
+            RGB cell_col((r & 0xF8) | 4, (g & 0xF8) | 4, (b & 0xF8) | 4);
+            nearest_cache[key] = cell_col.closest(palette_rgb, palette_size);
+            nearest_cache_valid[key >> 5] |= valid_bit;
+        }
+        return nearest_cache[key];
     }
     int PicoGraphics_PenDVHSTX_P8::update_pen(uint8_t i, uint8_t r, uint8_t g, uint8_t b) {
         used[i] = true;
         cache_built = false;
+        palette_rgb_built = false;
         driver.set_palette_colour(i, RGB_to_RGB888(r, g, b));
         return i;
     }
@@ -44,6 +75,7 @@ namespace pimoroni {
             if(!used[i]) {
                 used[i] = true;
                 cache_built = false;
+                palette_rgb_built = false;
                 driver.set_palette_colour(i, RGB_to_RGB888(r, g, b));
                 return i;
             }
@@ -58,6 +90,7 @@ namespace pimoroni {
         driver.set_palette_colour(i, 0);
         used[i] = false;
         cache_built = false;
+        palette_rgb_built = false;
         return i;
     }
     void PicoGraphics_PenDVHSTX_P8::set_pixel(const Point &p) {
@@ -86,27 +119,123 @@ namespace pimoroni {
     void PicoGraphics_PenDVHSTX_P8::set_pixel_dither(const Point &p, const RGB &c) {
         if(!bounds.contains(p)) return;
 
-        if(!cache_built) {
-            RGB888 *driver_palette = driver.get_palette();
-            RGB palette[palette_size];
-            for(auto i = 0u; i < palette_size; i++) {
-                palette[i] = RGB((uint)driver_palette[i]);
-            }
+        // set the pixel
+        color = get_dither_colour(p, c);
+        set_pixel(p);
+    }
 
-            for(uint i = 0; i < 512; i++) {
-                RGB cache_col((i & 0x1C0) >> 1, (i & 0x38) << 2, (i & 0x7) << 5);
-                get_dither_candidates(cache_col, palette, palette_size, candidate_cache[i]);
-            }
+    void PicoGraphics_PenDVHSTX_P8::set_pixel_span_dither(const Point &p, uint l, const RGB &c) {
+        if(p.y < bounds.y || p.y >= bounds.y + bounds.h) return;
+        int32_t x = std::max(p.x, bounds.x);
+        const int32_t x_end = std::min(p.x + (int32_t)l, bounds.x + bounds.w);
+        if(x >= x_end) return;
+
+        // Within a row the pattern repeats every 4 pixels
+        const std::array<uint8_t, 16> &row_candidates = get_dither_candidates(c);
+        const uint pattern_row = (p.y & 0b11) << 2;
+        uint8_t span[TILE_SPAN];
+        for(int i = 0; i < TILE_SPAN; i++) {
+            span[i] = row_candidates[dither16_pattern[pattern_row | ((x + i) & 0b11)]];
+        }
+
+        // TILE_SPAN is a multiple of 4, so each chunk starts at the same point in the pattern
+        while(x < x_end) {
+            const int len = std::min(x_end - x, (int32_t)TILE_SPAN);
+            driver.write_palette_pixel_span(Point(x, p.y), len, span);
+            x += len;
+        }
+    }
+
+    const std::array<uint8_t, 16>& PicoGraphics_PenDVHSTX_P8::get_dither_candidates(const RGB &c) {
+        if(!cache_built || candidate_generation != driver.get_palette_generation()) {
+            build_palette_rgb();
+            candidate_cache_valid.fill(0);
+            candidate_generation = palette_generation;
             cache_built = true;
         }
 
         uint cache_key = ((c.r & 0xE0) << 1) | ((c.g & 0xE0) >> 2) | ((c.b & 0xE0) >> 5);
 
+        // Searching for the candidates is slow, so only do it for colours that are used
+        const uint32_t valid_bit = 1u << (cache_key & 31);
+        if(!(candidate_cache_valid[cache_key >> 5] & valid_bit)) {
+            RGB cache_col((cache_key & 0x1C0) >> 1, (cache_key & 0x38) << 2, (cache_key & 0x7) << 5);
+            get_dither_candidates(cache_col, palette_rgb, palette_size, candidate_cache[cache_key]);
+            candidate_cache_valid[cache_key >> 5] |= valid_bit;
+        }
+
+        return candidate_cache[cache_key];
+    }
+
+    uint8_t PicoGraphics_PenDVHSTX_P8::get_dither_colour(const Point &p, const RGB &c) {
         // find the pattern coordinate offset
         uint pattern_index = (p.x & 0b11) | ((p.y & 0b11) << 2);
 
-        // set the pixel
-        color = candidate_cache[cache_key][dither16_pattern[pattern_index]];
-        set_pixel(p);
+        return get_dither_candidates(c)[dither16_pattern[pattern_index]];
+    }
+
+    bool PicoGraphics_PenDVHSTX_P8::render_tile(const Tile *tile) {
+        const RGB888 *driver_palette = driver.get_palette();
+        const RGB pen_colour((uint)driver_palette[color]);
+
+        // Covered pixels are set to the pen, partly covered pixels to a dither
+        // of the pen blended with the pixel's current colour.
+        uint8_t span[TILE_SPAN];
+        for(int y = 0; y < tile->h; y++) {
+            const uint8_t *alpha_ptr = &tile->data[y * tile->stride];
+            for(int x = 0; x < tile->w; x += TILE_SPAN) {
+                const int len = std::min(tile->w - x, (int32_t)TILE_SPAN);
+                const Point p(tile->x + x, tile->y + y);
+                driver.read_palette_pixel_span(p, len, span);
+
+                for(int i = 0; i < len; i++) {
+                    const uint8_t alpha = alpha_ptr[x + i];
+                    if(alpha == 0) continue;
+                    if(alpha == 255) {
+                        span[i] = color;
+                        continue;
+                    }
+
+                    const RGB target((uint)driver_palette[span[i]]);
+                    span[i] = get_dither_colour(Point(p.x + i, p.y), target.blend(pen_colour, alpha));
+                }
+
+                driver.write_palette_pixel_span(p, len, span);
+            }
+        }
+        return true;
+    }
+
+    void PicoGraphics_PenDVHSTX_P8::shade_span_3d(const Point &p, uint l, uint16_t *depth, const ShadeSpan &s) {
+        uint8_t *ptr = driver.get_palette_pixel_ptr(p);
+        if(!ptr) return;
+        int32_t z = s.z;
+        int32_t r = s.r, g = s.g, b = s.b;
+
+        // Flat spans only need to look up the dither candidates once
+        if((s.dr | s.dg | s.db) == 0) {
+            const std::array<uint8_t, 16> &flat_candidates = get_dither_candidates(RGB(r >> 16, g >> 16, b >> 16));
+            const uint pattern_row = (p.y & 0b11) << 2;
+
+            for(uint i = 0; i < l; i++) {
+                if(!depth || (uint32_t)(z >> 8) < depth[i]) {
+                    if(depth) depth[i] = z >> 8;
+                    ptr[i] = flat_candidates[dither16_pattern[pattern_row | ((p.x + i) & 0b11)]];
+                }
+                z += s.dz;
+            }
+            return;
+        }
+
+        for(uint i = 0; i < l; i++) {
+            if(!depth || (uint32_t)(z >> 8) < depth[i]) {
+                if(depth) depth[i] = z >> 8;
+                ptr[i] = get_dither_colour(Point(p.x + i, p.y), RGB(r >> 16, g >> 16, b >> 16));
+            }
+            z += s.dz;
+            r += s.dr;
+            g += s.dg;
+            b += s.db;
+        }
     }
 }
@@ -48,11 +48,13 @@ namespace pimoroni {
         driver.write_pixel_span(p, l, color);
     }
     void PicoGraphics_PenDVHSTX_RGB565::set_pixel_alpha(const Point &p, const uint8_t a) {
-        uint16_t src = background;
         if (blend_mode == BlendMode::TARGET) {
-            driver.read_pixel_span(p, 1, &src);
+            driver.blend_pixel_span(p, 1, color, a);
+            return;
         }
 
+        uint16_t src = background;
+
         uint8_t src_r = (src >> 8) & 0b11111000;
         uint8_t src_g = (src >> 3) & 0b11111100;
         uint8_t src_b = (src << 3) & 0b11111000;
@@ -66,7 +68,66 @@ namespace pimoroni {
         driver.write_pixel(p, blended);
     }
 
+    // Spread an RGB565 colour out so that all three channels can be blended with one multiply
+    static inline uint32_t rgb565_spread(uint16_t c) {
+        return (c | ((uint32_t)c << 16)) & 0x07E0F81F;
+    }
+
     bool PicoGraphics_PenDVHSTX_RGB565::render_tile(const Tile* tile) {
-        return false;
+        if(blend_mode == BlendMode::TARGET) {
+            for(int y = 0; y < tile->h; y++) {
+                driver.blend_pixel_span(Point(tile->x, tile->y + y), tile->w, color, &tile->data[y * tile->stride]);
+            }
+            return true;
+        }
+
+        const uint32_t fg = rgb565_spread(color);
+        const uint32_t bg = rgb565_spread(background);
+
+        // Blend each row of the tile with the background a span at a time,
+        // through a copy of the frame buffer so uncovered pixels are unchanged.
+        uint16_t span[TILE_SPAN];
+        for(int y = 0; y < tile->h; y++) {
+            const uint8_t* alpha_ptr = &tile->data[y * tile->stride];
+            for(int x = 0; x < tile->w; x += TILE_SPAN) {
+                const int len = std::min(tile->w - x, (int32_t)TILE_SPAN);
+                const Point p(tile->x + x, tile->y + y);
+                driver.read_pixel_span(p, len, span);
+
+                for(int i = 0; i < len; i++) {
+                    const uint32_t alpha = alpha_ptr[x + i];
+                    if(alpha == 0) continue;
+                    if(alpha == 255) {
+                        span[i] = color;
+                        continue;
+                    }
+
+                    const uint32_t a = (alpha + 4) >> 3;
+                    const uint32_t blended = ((((fg - bg) * a) >> 5) + bg) & 0x07E0F81F;
+                    span[i] = blended | (blended >> 16);
+                }
+
+                driver.write_pixel_span(p, len, span);
+            }
+        }
+        return true;
+    }
+
+    void PicoGraphics_PenDVHSTX_RGB565::shade_span_3d(const Point &p, uint l, uint16_t *depth, const ShadeSpan &s) {
+        uint16_t *ptr = driver.get_pixel_ptr16(p);
+        if(!ptr) return;
+        int32_t z = s.z;
+        int32_t r = s.r, g = s.g, b = s.b;
+
+        for(uint i = 0; i < l; i++) {
+            if(!depth || (uint32_t)(z >> 8) < depth[i]) {
+                if(depth) depth[i] = z >> 8;
+                ptr[i] = ((r >> 8) & 0xF800) | ((g >> 13) & 0x07E0) | (b >> 19);
+            }
+            z += s.dz;
+            r += s.dr;
+            g += s.dg;
+            b += s.db;
+        }
     }
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@ target_sources(usermod_${MOD_NAME} INTERFACE
     ${PICOVISION_PATH}/drivers/dvhstx/dvi.cpp
     ${PICOVISION_PATH}/drivers/dvhstx/intel_one_mono_2bpp.c
     ${PIMORONI_PICO_PATH}/libraries/pico_graphics/pico_graphics.cpp
+    ${PICOVISION_PATH}/libraries/pico_graphics/pico_graphics_dvhstx.cpp
     ${PICOVISION_PATH}/libraries/pico_graphics/pico_graphics_pen_dvhstx_rgb565.cpp
     ${PICOVISION_PATH}/libraries/pico_graphics/pico_graphics_pen_dvhstx_p8.cpp
     ${PIMORONI_PICO_PATH}/libraries/pico_graphics/types.cpp
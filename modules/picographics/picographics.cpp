@@ -46,6 +46,9 @@ typedef struct _ModPicoGraphics_obj_t {
     mp_obj_base_t base;
     PicoGraphicsDVHSTX *graphics;
     DVHSTX *display;
+    mp_obj_t tileset;
+    mp_obj_t depth_buffer;
+    DVHSTX::Mode pixel_mode;
 } ModPicoGraphics_obj_t;
 
 size_t get_required_buffer_size(PicoGraphicsPenType pen_type, uint width, uint height) {
@@ -110,6 +113,9 @@ mp_obj_t ModPicoGraphics_make_new(const mp_obj_type_t *type, size_t n_args, size
     dvhstx_debug("DVHSTX created\n");
 
     self->display = &dv_display;
+    self->tileset = mp_const_none;
+    self->depth_buffer = mp_const_none;
+    self->pixel_mode = dv_display.get_mode();
 
     // Clear each buffer
     for(auto x = 0u; x < 2u; x++){
@@ -504,6 +510,16 @@ mp_obj_t ModPicoGraphics_measure_text(size_t n_args, const mp_obj_t *pos_args, m
     return mp_obj_new_int(width);
 }
 
+static Point get_polygon_point(mp_obj_t obj) {
+    if(!mp_obj_is_type(obj, &mp_type_tuple)) mp_raise_ValueError("poly(): can't convert object to tuple");
+
+    mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR2(obj, mp_obj_tuple_t);
+
+    if(tuple->len != 2) mp_raise_ValueError("poly(): tuple must only contain two numbers");
+
+    return Point(mp_obj_get_int(tuple->items[0]), mp_obj_get_int(tuple->items[1]));
+}
+
 mp_obj_t ModPicoGraphics_polygon(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     size_t num_tuples = n_args - 1;
     const mp_obj_t *tuples = pos_args + 1;
@@ -525,23 +541,21 @@ mp_obj_t ModPicoGraphics_polygon(size_t n_args, const mp_obj_t *pos_args, mp_map
         }
     }
 
-    if(num_tuples > 0) {
+    if(num_tuples > PicoGraphicsDVHSTX::MAX_POLYGON_EDGES) {
         std::vector<Point> points;
         for(size_t i = 0; i < num_tuples; i++) {
-            mp_obj_t obj = tuples[i];
-            if(!mp_obj_is_type(obj, &mp_type_tuple)) mp_raise_ValueError("poly(): can't convert object to tuple");
-
-            mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR2(obj, mp_obj_tuple_t);
-
-            if(tuple->len != 2) mp_raise_ValueError("poly(): tuple must only contain two numbers");
-
-            points.push_back({
-                mp_obj_get_int(tuple->items[0]),
-                mp_obj_get_int(tuple->items[1])
-            });
+            points.push_back(get_polygon_point(tuples[i]));
         }
         self->graphics->polygon(points);
     }
+    else if(num_tuples > 0) {
+        // Fill without allocating, using the edge table filler
+        static Point points[PicoGraphicsDVHSTX::MAX_POLYGON_EDGES];
+        for(size_t i = 0; i < num_tuples; i++) {
+            points[i] = get_polygon_point(tuples[i]);
+        }
+        self->graphics->fill_polygon(points, num_tuples);
+    }
 
     return mp_const_none;
 }
@@ -589,6 +603,240 @@ mp_obj_t ModPicoGraphics_line(size_t n_args, const mp_obj_t *args) {
     return mp_const_none;
 }
 
+// Re-initialise the display in a new mode, keeping the palette, and clear both buffers
+static void switch_display_mode(ModPicoGraphics_obj_t *self, DVHSTX::Mode mode) {
+    RGB888 palette[DVHSTX::PALETTE_SIZE];
+    memcpy(palette, self->display->get_palette(), sizeof(palette));
+
+    if(!self->display->init(self->graphics->bounds.w, self->graphics->bounds.h, mode)) {
+        mp_raise_msg(&mp_type_RuntimeError, "PicoVision: Unsupported Mode!");
+    }
+    self->display->set_palette(palette);
+
+    for(auto x = 0u; x < 2u; x++){
+        self->display->clear();
+        self->display->flip_now();
+    }
+}
+
+mp_obj_t ModPicoGraphics_tilemap(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_self, ARG_tiles, ARG_tile_size };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_tiles, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_tile_size, MP_ARG_INT, {.u_int = 8} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    ModPicoGraphics_obj_t *self = MP_OBJ_TO_PTR2(args[ARG_self].u_obj, ModPicoGraphics_obj_t);
+    const DVHSTX::Mode mode = self->display->get_mode();
+    const bool is_tilemap = mode == DVHSTX::MODE_TILEMAP_PALETTE || mode == DVHSTX::MODE_TILEMAP_RGB565;
+
+    if(args[ARG_tiles].u_obj == mp_const_none) {
+        // Leave the tile map, back to the pixel mode it was entered from
+        if(is_tilemap) switch_display_mode(self, self->pixel_mode);
+        self->tileset = mp_const_none;
+        return mp_const_none;
+    }
+
+    int tile_size = args[ARG_tile_size].u_int;
+    if(tile_size != 8 && tile_size != 16) mp_raise_ValueError("tilemap(): tile_size must be 8 or 16");
+
+    DVHSTX::Mode tile_mode;
+    size_t bytes_per_pixel;
+    switch(mode) {
+        case DVHSTX::MODE_PALETTE:
+        case DVHSTX::MODE_PALETTE_RGB565:
+        case DVHSTX::MODE_TILEMAP_PALETTE:
+            tile_mode = DVHSTX::MODE_TILEMAP_PALETTE;
+            bytes_per_pixel = 1;
+            break;
+        case DVHSTX::MODE_RGB565:
+        case DVHSTX::MODE_TILEMAP_RGB565:
+            tile_mode = DVHSTX::MODE_TILEMAP_RGB565;
+            bytes_per_pixel = 2;
+            break;
+        default:
+            mp_raise_ValueError("tilemap(): unsupported pen type");
+    }
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[ARG_tiles].u_obj, &bufinfo, MP_BUFFER_READ);
+    const size_t tile_bytes = tile_size * tile_size * bytes_per_pixel;
+    if(bufinfo.len < tile_bytes) mp_raise_ValueError("tilemap(): tiles buffer too small");
+
+    if(mode != tile_mode) {
+        // Switch the display over to the tile map, remembering the mode to return to
+        if(!is_tilemap) self->pixel_mode = mode;
+        switch_display_mode(self, tile_mode);
+    }
+
+    self->tileset = args[ARG_tiles].u_obj;
+    self->display->set_tileset((const uint8_t *)bufinfo.buf, tile_size, std::min(bufinfo.len / tile_bytes, (size_t)256));
+
+    return mp_const_none;
+}
+
+mp_obj_t ModPicoGraphics_set_tile(size_t n_args, const mp_obj_t *args) {
+    enum { ARG_self, ARG_x, ARG_y, ARG_tile };
+
+    ModPicoGraphics_obj_t *self = MP_OBJ_TO_PTR2(args[ARG_self], ModPicoGraphics_obj_t);
+
+    int x = mp_obj_get_int(args[ARG_x]);
+    int y = mp_obj_get_int(args[ARG_y]);
+    int tile = mp_obj_get_int(args[ARG_tile]);
+
+    if(x < 0 || x >= self->display->get_tilemap_width() || y < 0 || y >= self->display->get_tilemap_height()) {
+        mp_raise_ValueError("set_tile(): x or y outside the tile map");
+    }
+    if(tile < 0 || tile >= (int)self->display->get_tile_count()) {
+        mp_raise_ValueError("set_tile(): tile not in the tileset");
+    }
+
+    self->display->write_tile({x, y}, tile);
+
+    return mp_const_none;
+}
+
+mp_obj_t ModPicoGraphics_blit(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_self, ARG_data, ARG_x, ARG_y, ARG_w, ARG_h, ARG_stride, ARG_key, ARG_rgb332, ARG_palette };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_data, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_x, MP_ARG_REQUIRED | MP_ARG_INT },
+        { MP_QSTR_y, MP_ARG_REQUIRED | MP_ARG_INT },
+        { MP_QSTR_w, MP_ARG_REQUIRED | MP_ARG_INT },
+        { MP_QSTR_h, MP_ARG_REQUIRED | MP_ARG_INT },
+        { MP_QSTR_stride, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_key, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = -1} },
+        { MP_QSTR_rgb332, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_palette, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    ModPicoGraphics_obj_t *self = MP_OBJ_TO_PTR2(args[ARG_self].u_obj, ModPicoGraphics_obj_t);
+
+    int w = args[ARG_w].u_int;
+    int h = args[ARG_h].u_int;
+    int stride = args[ARG_stride].u_int > 0 ? args[ARG_stride].u_int : w;
+    if(w <= 0 || h <= 0) return mp_const_none;
+    if(stride < w) mp_raise_ValueError("blit(): stride less than width");
+
+    DVHSTX::BlitFormat format;
+    size_t bytes_per_pixel = 1;
+    const uint16_t *src_palette = nullptr;
+    switch(self->display->get_mode()) {
+        case DVHSTX::MODE_PALETTE:
+        case DVHSTX::MODE_PALETTE_RGB565:
+            if(args[ARG_palette].u_obj != mp_const_none || args[ARG_rgb332].u_bool) {
+                mp_raise_ValueError("blit(): rgb332 and palette need an RGB565 pen");
+            }
+            format = DVHSTX::BLIT_P8;
+            break;
+        case DVHSTX::MODE_RGB565:
+            if(args[ARG_palette].u_obj != mp_const_none) {
+                mp_buffer_info_t palette_info;
+                mp_get_buffer_raise(args[ARG_palette].u_obj, &palette_info, MP_BUFFER_READ);
+                if(palette_info.len < DVHSTX::PALETTE_SIZE * 2) mp_raise_ValueError("blit(): palette must have 256 RGB565 colours");
+                src_palette = (const uint16_t *)palette_info.buf;
+                format = DVHSTX::BLIT_P8_TO_RGB565;
+            }
+            else if(args[ARG_rgb332].u_bool) {
+                format = DVHSTX::BLIT_RGB332_TO_RGB565;
+            }
+            else {
+                format = DVHSTX::BLIT_RGB565;
+                bytes_per_pixel = 2;
+            }
+            break;
+        default:
+            mp_raise_ValueError("blit(): unsupported pen type");
+    }
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[ARG_data].u_obj, &bufinfo, MP_BUFFER_READ);
+    if(bufinfo.len < ((uint64_t)stride * (h - 1) + w) * bytes_per_pixel) mp_raise_ValueError("blit(): data buffer too small");
+    if(bytes_per_pixel == 2 && ((uintptr_t)bufinfo.buf & 1)) mp_raise_ValueError("blit(): data buffer not aligned");
+
+    self->display->blit(bufinfo.buf, stride, format,
+        {args[ARG_x].u_int, args[ARG_y].u_int, w, h},
+        self->graphics->clip, args[ARG_key].u_int, src_palette);
+
+    return mp_const_none;
+}
+
+mp_obj_t ModPicoGraphics_set_depth_buffer(mp_obj_t self_in, mp_obj_t buffer_in) {
+    ModPicoGraphics_obj_t *self = MP_OBJ_TO_PTR2(self_in, ModPicoGraphics_obj_t);
+
+    if(buffer_in == mp_const_none) {
+        self->graphics->set_depth_buffer(nullptr);
+    }
+    else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(buffer_in, &bufinfo, MP_BUFFER_RW);
+        if(bufinfo.len < (size_t)(self->graphics->bounds.w * self->graphics->bounds.h * sizeof(uint16_t))) mp_raise_ValueError("set_depth_buffer(): buffer too small");
+        if((uintptr_t)bufinfo.buf & 1) mp_raise_ValueError("set_depth_buffer(): buffer not aligned");
+        self->graphics->set_depth_buffer((uint16_t *)bufinfo.buf);
+    }
+    self->depth_buffer = buffer_in;
+
+    return mp_const_none;
+}
+
+mp_obj_t ModPicoGraphics_clear_depth_buffer(mp_obj_t self_in) {
+    ModPicoGraphics_obj_t *self = MP_OBJ_TO_PTR2(self_in, ModPicoGraphics_obj_t);
+    self->graphics->clear_depth_buffer();
+    return mp_const_none;
+}
+
+static PicoGraphicsDVHSTX::Vertex3D get_vertex_3d(mp_obj_t obj) {
+    if(!mp_obj_is_type(obj, &mp_type_tuple)) mp_raise_ValueError("triangle_3d(): can't convert object to tuple");
+
+    mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR2(obj, mp_obj_tuple_t);
+
+    if(tuple->len != 6) mp_raise_ValueError("triangle_3d(): vertex must be (x, y, z, r, g, b)");
+
+    PicoGraphicsDVHSTX::Vertex3D v;
+    v.x = mp_obj_get_int(tuple->items[0]);
+    v.y = mp_obj_get_int(tuple->items[1]);
+    v.z = std::clamp(mp_obj_get_int(tuple->items[2]), 0, 0xFFFF);
+    v.colour = RGB(
+        (int16_t)std::clamp(mp_obj_get_int(tuple->items[3]), 0, 255),
+        (int16_t)std::clamp(mp_obj_get_int(tuple->items[4]), 0, 255),
+        (int16_t)std::clamp(mp_obj_get_int(tuple->items[5]), 0, 255)
+    );
+    return v;
+}
+
+mp_obj_t ModPicoGraphics_triangle_3d(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_self, ARG_v0, ARG_v1, ARG_v2, ARG_smooth };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_v0, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_v1, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_v2, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_smooth, MP_ARG_BOOL, {.u_bool = true} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    ModPicoGraphics_obj_t *self = MP_OBJ_TO_PTR2(args[ARG_self].u_obj, ModPicoGraphics_obj_t);
+
+    self->graphics->triangle_3d(
+        get_vertex_3d(args[ARG_v0].u_obj),
+        get_vertex_3d(args[ARG_v1].u_obj),
+        get_vertex_3d(args[ARG_v2].u_obj),
+        args[ARG_smooth].u_bool
+    );
+
+    return mp_const_none;
+}
+
 mp_obj_t ModPicoGraphics_loop(mp_obj_t self_in, mp_obj_t update, mp_obj_t render) {
     (void)self_in;
     /*
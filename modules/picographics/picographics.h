@@ -30,6 +30,11 @@ extern mp_obj_t ModPicoGraphics_get_required_buffer_size(mp_obj_t display_in, mp
 extern mp_obj_t ModPicoGraphics_set_scroll_group_offset(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
 extern mp_obj_t ModPicoGraphics_set_scroll_group_for_lines(size_t n_args, const mp_obj_t *args);
 extern mp_obj_t ModPicoGraphics_tilemap(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
+extern mp_obj_t ModPicoGraphics_set_tile(size_t n_args, const mp_obj_t *args);
+extern mp_obj_t ModPicoGraphics_blit(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
+extern mp_obj_t ModPicoGraphics_set_depth_buffer(mp_obj_t self_in, mp_obj_t buffer_in);
+extern mp_obj_t ModPicoGraphics_clear_depth_buffer(mp_obj_t self_in);
+extern mp_obj_t ModPicoGraphics_triangle_3d(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
 extern mp_obj_t ModPicoGraphics_load_animation(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
 
 // Class methods
@@ -7,6 +7,7 @@ add_library(${LIB_NAME} INTERFACE)
 target_sources(${LIB_NAME} INTERFACE
     ${PIMORONI_PICO_PATH}/libraries/pico_graphics/pico_graphics.cpp
 #    ${CMAKE_CURRENT_LIST_DIR}/libraries/pico_graphics/pico_graphics_pen_dvhstx_rgb888.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/libraries/pico_graphics/pico_graphics_dvhstx.cpp
     ${CMAKE_CURRENT_LIST_DIR}/libraries/pico_graphics/pico_graphics_pen_dvhstx_rgb565.cpp
     ${CMAKE_CURRENT_LIST_DIR}/libraries/pico_graphics/pico_graphics_pen_dvhstx_p8.cpp
     ${PIMORONI_PICO_PATH}/libraries/pico_graphics/types.cpp